@@ -13,14 +13,32 @@
 
 /* This class is used to manage maintaining only a single instance of QEGui when required.
 
-    On creation it attempts to connect to a server on an already running QEGui.
-    If it can't connect, it assumes it is the only version of QEGui and starts the server itself.
+    On creation, if only a single instance of the application is required, it attempts to connect to a server
+    on an already running QEGui. The attempt is only made if the server's socket file exists (where the platform
+    uses one), so when there is no other instance the check costs next to nothing.
+    If it doesn't connect, it assumes it is the only version of QEGui and starts the server itself. The server is
+    started once the event loop is running, so it does not delay construction of the first windows.
 
     When QEGui starts with a -s parameter, indicating that only a single instance of the application is required,
     It passes all the startup parameters to the handball() method of this class.
 
     If this class has connected to a server, it passes the startup parameters to the server and then stops. The QEGui
     application running the server then starts a new main window based on the handballed parameters.
+
+    Messages between instances are framed. Each frame is a 32 bit length followed by a header (magic number,
+    protocol version, message type and request id) and the message body. A connection may carry any number of
+    frames, and frames may arrive split or merged in any way, so bursts of requests are never lost or combined.
+    Each request is acknowledged twice. It is accepted (or rejected if it can't be read) as soon as it is
+    received, and queued. Once it has been acted on it is completed, with the id of the window presenting it
+    and the time taken to create it. A request for several GUI files is sent as a request per file, all sent
+    before waiting for any acknowledgement. The new instance opens itself only what was rejected, what the
+    other instance could not act on, and what was not accepted before the connection was lost. Once accepted,
+    a request is always acted on by the other instance, however long it takes, so nothing is opened twice.
+
+    In server mode (-i) no window is opened at startup. Instead, the designer plugins are loaded in advance,
+    any GUI files given are read in advance (but no GUI is built), and a small pool of hidden main windows
+    (with no GUI) is constructed. A main window is taken from the pool (and the pool
+    replenished when idle) when a new window is requested, rather than being constructed from scratch.
     If this class is not connected to a server, the handball() method returns indicating that it was unable to handball
     the parameters and this instance of QEGui should start a new window regardless of the -s parameter.
 */
@@ -30,62 +48,188 @@
 #include <MainWindow.h>
 #include <ContainerProfile.h>
 #include <QEGui.h>
+#include <startupTrace.h>
+#include <configStore.h>
 #include <QMessageBox>
 #include <QDebug>
+#include <QDataStream>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QTimer>
+#include <QUiLoader>
 
 #define DEBUG qDebug () << "InstanceManager" << __LINE__ << __FUNCTION__ << "  "
 
 #define QEGUISERVERNAME "QEGuiInstance"
 
+// Instance protocol
+#define PROTOCOL_MAGIC        0x51454749     // "QEGI"
+#define PROTOCOL_VERSION      1
+#define PROTOCOL_HEADER_SIZE  11             // magic (4), version (2), type (1), request id (4)
+#define PROTOCOL_MAX_FRAME    ( 16 * 1024 * 1024 )
+
+#define MESSAGE_OPEN_REQUEST  1              // Body is serialised startup parameters
+#define MESSAGE_OPEN_ACK      2              // Request completed. Body is status, window id and time taken
+#define MESSAGE_OPEN_ACCEPT   3              // Request received and queued. Body is status
+
+#define HANDBALL_TIMEOUT      10000          // mS
+
+#define SHELL_POOL_SIZE       2              // Number of pre-constructed main windows kept in server mode
+
 //------------------------------------------------------------------------------
 // Construction
-// Look for an instance server, and if can't find one, then start one
+// If required, look for an instance server, and if can't find one, then start one
 instanceManager::instanceManager( QEGui* appIn ) : QObject( appIn )
 {
     app = appIn;
+    socket = NULL;
+    server = NULL;
+    probe = NULL;
+    nextRequestId = 1;
+    processingRequests = false;
+    shellPoolEnabled = false;
+
+    serverName = serverNameFor( QString::fromLocal8Bit( qgetenv( "QEGUI_INSTANCE_NAME" ) ) );
+
+    // Only look for another instance if the parameters may be passed on to it (-s).
+    // Don't bother trying to connect at all if there is clearly no server.
+    if( app->getParams()->singleApp && serverMayBePresent() )
+    {
+        // Create a socket.
+        // Connecting to a local server either succeeds or fails almost immediately,
+        // the timeout only applies if the other instance is not responding.
+        socket = new QLocalSocket(this);
+        socket->connectToServer( serverName, QIODevice::ReadWrite );
+
+        // If no other instance is found, discard the socket
+        // (no socket will be used to indicate no other instance)
+        if( !socket->waitForConnected( 1000 ) )
+        {
+            delete socket;
+            socket = NULL;
+        }
+    }
+
+    // If no other instance is being used, start a server for future instances.
+    // This is deferred until the event loop is running so it proceeds in parallel with window creation.
+    if( !socket )
+    {
+        QTimer::singleShot( 0, this, SLOT( startServer() ) );
+    }
+}
 
-    // Build the server name to be <user>_<QEGUISERVERNAME>
-    // The username is included since (on Linux at least) a temporary file is
-    // created (in /tmp on Linux) using the name of the server.
-    // For multiple users this avoids conflict. Also, if a temporary
-    // file has been left following a crash by a different user, the
-    // temporary file can't be deleted if permissions don't allow. This results
-    // in the server unable to start.
+//------------------------------------------------------------------------------
+// Return the name of the instance server for an instance name (normally empty).
+// The name is <QEGUISERVERNAME>_<user>[_<instance name>]
+// The username is included since (on Linux at least) a temporary file is
+// created (in /tmp on Linux) using the name of the server.
+// For multiple users this avoids conflict. Also, if a temporary
+// file has been left following a crash by a different user, the
+// temporary file can't be deleted if permissions don't allow. This results
+// in the server unable to start.
+// A group of instances may keep to themselves by sharing a private instance name
+// (QEGUI_INSTANCE_NAME). This is used by benchmark runs, so their second instances
+// don't hand over to the user's QEGui.
+QString instanceManager::serverNameFor( const QString& instanceName )
+{
     QByteArray userEnv;
 #ifdef WIN32 //for windows
     userEnv = qgetenv( "USERNAME" );
 #else //for Mac or Linux
     userEnv = qgetenv( "USER" );
 #endif
-    QString serverName = QString( QEGUISERVERNAME ).append( "_" ).append( userEnv );
+    QString name = QString( QEGUISERVERNAME ).append( "_" ).append( QString::fromLocal8Bit( userEnv ) );
+    if( !instanceName.isEmpty() )
+    {
+        name.append( "_" ).append( instanceName );
+    }
+    return name;
+}
 
-    // Create a socket
-    socket = new QLocalSocket(this);
-    socket->connectToServer( serverName, QIODevice::WriteOnly );
+//------------------------------------------------------------------------------
+// Quick check for another instance, without attempting to connect to it.
+// On Linux (and Mac) a local server creates a socket file in the temporary directory.
+// If that does not exist there is definitely no server. (It may be left over from
+// a crash, so if it does exist there may or may not be a server.)
+bool instanceManager::serverMayBePresent()
+{
+#ifdef WIN32
+    return true;    // Named pipes are used - no file to check
+#else
+    return QFileInfo( QDir( QDir::tempPath() ).filePath( serverName ) ).exists();
+#endif
+}
 
-    // Assume no server
-    server = NULL;
+//------------------------------------------------------------------------------
+// Start a server to listen for other instances of QEGui starting
+void instanceManager::startServer()
+{
+    if( server )
+    {
+        return;
+    }
 
-    // If no other instance is found, discard the socket  and start a server for future instances
-    // (no socket will be used to indicate no other instance)
-    if( !socket->waitForConnected( 1000 ) )
+    server = new QLocalServer( this );
+    connect( server, SIGNAL(newConnection()), this, SLOT(connected()));
+    if( server->listen( serverName ))
     {
-        delete socket;
-        socket = 0;
+        return;
+    }
 
-        // Kill any other server.
-        // This is required if an eariler instance has crashed
-        QLocalServer::removeServer( serverName );
+    // If the name is in use, either another instance is running, or an earlier instance
+    // has crashed leaving its socket file. Check (without blocking) which it is.
+    if( server->serverError() == QAbstractSocket::AddressInUseError && !probe )
+    {
+        delete server;
+        server = NULL;
 
-        // Start a server to listen for other instances of QEGui starting
-        server = new QLocalServer( this );
-        connect( server, SIGNAL(newConnection()), this, SLOT(connected()));
-        if( !server->listen( serverName ))
-        {
-            qDebug() << QString( "Couldn't start server. On Linux, check if there is a temporary file /tmp/" ).append( serverName ).append( " and delete it" );
-            delete server;
-            server = NULL;
-        }
+        probe = new QLocalSocket( this );
+        connect( probe, SIGNAL(stateChanged(QLocalSocket::LocalSocketState)),
+                 this,  SLOT(probeStateChanged(QLocalSocket::LocalSocketState)));
+        probe->connectToServer( serverName, QIODevice::WriteOnly );
+        return;
+    }
+
+    qDebug() << QString( "Couldn't start server. On Linux, check if there is a temporary file /tmp/" ).append( serverName ).append( " and delete it" );
+    delete server;
+    server = NULL;
+}
+
+//------------------------------------------------------------------------------
+// Result of checking if the server name in use belongs to a live instance
+void instanceManager::probeStateChanged( QLocalSocket::LocalSocketState state )
+{
+    switch( state )
+    {
+        case QLocalSocket::ConnectedState:
+            // Another instance is running and will serve future instances. Leave it be.
+            // (Stop listening to the probe first, disconnecting is not a failure to connect)
+            probe->disconnect( this );
+            probe->disconnectFromServer();
+            probe->deleteLater();
+            probe = NULL;
+            break;
+
+        case QLocalSocket::UnconnectedState:
+            // No one is listening. Kill the old server (an eariler instance has crashed) and start our own.
+            // (If the old server can't be removed, don't keep probing it)
+            probe->disconnect( this );
+            probe->deleteLater();
+            probe = NULL;
+            if( QLocalServer::removeServer( serverName ) )
+            {
+                startServer();
+            }
+            else
+            {
+                qDebug() << QString( "Couldn't start server. On Linux, check if there is a temporary file /tmp/" ).append( serverName ).append( " and delete it" );
+            }
+            break;
+
+        default:
+            break;
     }
 }
 
@@ -93,61 +237,346 @@ instanceManager::instanceManager( QEGui* appIn ) : QObject( appIn )
 // Destruction
 instanceManager::~instanceManager()
 {
+    qDeleteAll( shells );
+    shells.clear();
+
     delete socket;
     if( server )
         delete server;
 }
 
 //------------------------------------------------------------------------------
-// Pass on the startup parameters to an already existing instance of the application
+// Build a message frame
+QByteArray instanceManager::buildFrame( const quint8 type, const quint32 requestId, const QByteArray& body )
+{
+    QByteArray frame;
+    QDataStream stream( &frame, QIODevice::WriteOnly );
+    stream.setVersion( QDataStream::Qt_5_6 );
+
+    stream << quint32( PROTOCOL_HEADER_SIZE + body.size() )
+           << quint32( PROTOCOL_MAGIC )
+           << quint16( PROTOCOL_VERSION )
+           << type
+           << requestId;
+    stream.writeRawData( body.constData(), body.size() );
+
+    return frame;
+}
+
+//------------------------------------------------------------------------------
+// Take the next complete message frame from the front of a receive buffer.
+// Return false if there is not yet a complete frame in the buffer.
+// If a frame is taken but is not valid (wrong protocol or version), isValid is set false.
+// If the buffer can't hold a frame at all, the buffer is cleared and isValid is set false.
+bool instanceManager::takeFrame( QByteArray& buffer, quint8& type, quint32& requestId, QByteArray& body, bool& isValid )
+{
+    isValid = false;
+
+    if( buffer.size() < 4 )
+    {
+        return false;
+    }
+
+    QDataStream lengthStream( buffer );
+    quint32 length;
+    lengthStream >> length;
+
+    if( length < PROTOCOL_HEADER_SIZE || length > PROTOCOL_MAX_FRAME )
+    {
+        // Not our protocol (or hopelessly out of step). Discard everything.
+        buffer.clear();
+        return true;
+    }
+
+    if( buffer.size() < int( 4 + length ) )
+    {
+        return false;
+    }
+
+    QDataStream stream( buffer.mid( 4, length ) );
+    stream.setVersion( QDataStream::Qt_5_6 );
+    buffer.remove( 0, 4 + length );
+
+    quint32 magic;
+    quint16 version;
+    stream >> magic >> version >> type >> requestId;
+
+    body.resize( length - PROTOCOL_HEADER_SIZE );
+    stream.readRawData( body.data(), body.size() );
+
+    isValid = ( magic == PROTOCOL_MAGIC ) && ( version == PROTOCOL_VERSION ) && ( stream.status() == QDataStream::Ok );
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Pass on the startup parameters to an already existing instance of the application.
+// Each GUI file is requested separately, and all requests are sent before waiting for any
+// acknowledgement, so the other instance can work through them without waiting for this one.
+// (A configuration restore, or a request with no more than one GUI file, is a single request.)
+// Returns true if the other instance has acted on, or is acting on, every request. If not, the
+// parameters are left holding only what it has not, for this instance to open itself.
 bool instanceManager::handball( startupParams* params )
 {
     // If no other instance, do nothing
     if( !socket )
         return false;
 
-    // Build a serial copy of the parameters
-    QByteArray ba;
-    params->setSharedParams( ba );
+    // Build the requests, noting the GUI files each is for
+    QHash<quint32, QStringList> outstanding;
+    QByteArray frames;
+    if( params->restore || params->filenameList.count() <= 1 )
+    {
+        QByteArray ba;
+        params->setSharedParams( ba );
+        outstanding.insert( nextRequestId, params->filenameList );
+        frames.append( buildFrame( MESSAGE_OPEN_REQUEST, nextRequestId++, ba ) );
+    }
+    else
+    {
+        for( int i = 0; i < params->filenameList.count(); i++ )
+        {
+            startupParams single = *params;
+            single.filenameList = QStringList( params->filenameList[i] );
 
-    // Send it to the other instance
-    socket->write( ba );
+            // Only offer to restore an auto-saved configuration once
+            if( i > 0 )
+            {
+                single.disableAutoSaveConfiguration = true;
+            }
 
-    // Wait until it is gone.
-    // The application will be closing down almost immedietly and if we don't
-    // wait here it doesn't get written
-    socket->waitForBytesWritten ( 10000 );
+            QByteArray ba;
+            single.setSharedParams( ba );
+            outstanding.insert( nextRequestId, single.filenameList );
+            frames.append( buildFrame( MESSAGE_OPEN_REQUEST, nextRequestId++, ba ) );
+        }
+    }
 
-    // Return indicating startup request has been hand-balled to another instance of QEGui
-    return true;
+    // Send them all to the other instance.
+    // (If they can't all be written, whatever the other instance does receive it will accept)
+    socket->write( frames );
+    socket->waitForBytesWritten( HANDBALL_TIMEOUT );
+
+    // Wait for the requests to be accepted, then (for a while) for them to be completed.
+    // The other instance accepts each request as soon as it receives it, and once accepted will act
+    // on it however long that takes. So this instance only opens what is rejected or not completed
+    // successfully, and what was not accepted before the connection was lost.
+    QHash<quint32, QStringList> accepted;           // Accepted, not yet completed
+    QHash<quint32, QStringList> local;              // To be opened by this instance
+    QByteArray buffer;
+    bool warned = false;
+    QElapsedTimer timer;
+    timer.start();
+    while( !outstanding.isEmpty() || ( !accepted.isEmpty() && timer.elapsed() < HANDBALL_TIMEOUT ) )
+    {
+        // Wait for more acknowledgements
+        if( !socket->waitForReadyRead( outstanding.isEmpty() ? int( HANDBALL_TIMEOUT - timer.elapsed() ) : HANDBALL_TIMEOUT ) )
+        {
+            // Connection lost, or nothing to wait for any longer but completions
+            if( socket->state() != QLocalSocket::ConnectedState || outstanding.isEmpty() )
+            {
+                break;
+            }
+
+            // Not accepted yet. The other instance may be busy. It will act on them once read, so keep waiting.
+            if( !warned )
+            {
+                qDebug() << "Waiting for the existing QEGui instance to accept the startup parameters";
+                warned = true;
+            }
+            continue;
+        }
+        buffer.append( socket->readAll() );
+
+        quint8 type;
+        quint32 ackId;
+        QByteArray body;
+        bool isValid;
+        while( takeFrame( buffer, type, ackId, body, isValid ) )
+        {
+            if( !isValid || ( type != MESSAGE_OPEN_ACCEPT && type != MESSAGE_OPEN_ACK ) )
+            {
+                continue;
+            }
+
+            QDataStream stream( body );
+            stream.setVersion( QDataStream::Qt_5_6 );
+            quint8 status = 0;
+            stream >> status;
+
+            if( !outstanding.contains( ackId ) && !accepted.contains( ackId ) )
+            {
+                continue;
+            }
+
+            // Note the request's new state. Anything rejected or not completed successfully is opened by this instance.
+            QStringList files = outstanding.contains( ackId ) ? outstanding.take( ackId ) : accepted.take( ackId );
+            if( status != 1 )
+            {
+                local.insert( ackId, files );
+            }
+            else if( type == MESSAGE_OPEN_ACCEPT )
+            {
+                accepted.insert( ackId, files );
+            }
+        }
+    }
+
+    // Anything not accepted before the connection was lost is opened by this instance too
+    local.unite( outstanding );
+
+    // All done (or being done) by the other instance
+    if( local.isEmpty() )
+    {
+        return true;
+    }
+
+    // This instance will have to open whatever the other instance has not
+    qDebug() << "Startup parameters passed to the existing QEGui instance were not acted on, starting locally";
+    if( local.count() < params->filenameList.count() )
+    {
+        QStringList remaining;
+        for( int i = 0; i < params->filenameList.count(); i++ )
+        {
+            QHash<quint32, QStringList>::const_iterator it;
+            for( it = local.constBegin(); it != local.constEnd(); ++it )
+            {
+                if( it.value().contains( params->filenameList[i] ) && !remaining.contains( params->filenameList[i] ) )
+                {
+                    remaining.append( params->filenameList[i] );
+                }
+            }
+        }
+        params->filenameList = remaining;
+    }
+    return false;
 }
 
 //------------------------------------------------------------------------------
 // Slot called when the server starts
 void instanceManager::connected()
 {
-    client = server->nextPendingConnection();
-    connect( client, SIGNAL(readyRead ()), this, SLOT(readParams()));
+    while( server && server->hasPendingConnections() )
+    {
+        QLocalSocket* client = server->nextPendingConnection();
+        clientBuffers.insert( client, QByteArray() );
+        connect( client, SIGNAL(readyRead ()), this, SLOT(readParams()));
+        connect( client, SIGNAL(disconnected ()), this, SLOT(clientDisconnected()));
+    }
+}
+
+//------------------------------------------------------------------------------
+// A new instance that connected has gone
+void instanceManager::clientDisconnected()
+{
+    QLocalSocket* client = qobject_cast<QLocalSocket*>( sender() );
+    if( client )
+    {
+        clientBuffers.remove( client );
+        client->deleteLater();
+    }
 }
 
 //------------------------------------------------------------------------------
 // Read the startup parameters from a new instance of the application.
 // The new instance wants this old instance to do the work.
-// It has passed on the startup parameters and will now exit
+// Any number of requests may be received, and any request may arrive in pieces.
+// Each request is accepted (or rejected if it can't be read) straight away and queued, then acted on.
 void instanceManager::readParams()
 {
-    QByteArray ba(client->readAll());
-    startupParams params;
-    if( params.getSharedParams( ba ) )
+    QLocalSocket* client = qobject_cast<QLocalSocket*>( sender() );
+    if( !client || !clientBuffers.contains( client ) )
     {
-        newWindow( params );
+        return;
     }
+
+    clientBuffers[client].append( client->readAll() );
+
+    quint8 type;
+    quint32 requestId;
+    QByteArray body;
+    bool isValid;
+    while( takeFrame( clientBuffers[client], type, requestId, body, isValid ) )
+    {
+        if( !isValid || type != MESSAGE_OPEN_REQUEST )
+        {
+            qDebug() << "Message from another QEGui instance ignored (unexpected message or protocol version)";
+            continue;
+        }
+
+        pendingRequest request;
+        request.client = client;
+        request.requestId = requestId;
+        request.timer.start();
+        const bool isReadable = request.params.getSharedParams( body );
+        if( isReadable )
+        {
+            pendingRequests.append( request );
+        }
+
+        // Accept (or reject) the request
+        QByteArray accept;
+        QDataStream stream( &accept, QIODevice::WriteOnly );
+        stream.setVersion( QDataStream::Qt_5_6 );
+        stream << quint8( isReadable ? 1 : 0 );
+        client->write( buildFrame( MESSAGE_OPEN_ACCEPT, requestId, accept ) );
+    }
+
+    // Send the acceptances now, before acting on any requests
+    client->flush();
+
+    processRequests();
 }
 
 //------------------------------------------------------------------------------
-// Create new main windows
-void instanceManager::newWindow( const startupParams& params )
+// Act on the requests accepted from other instances, in the order they were received.
+// Acting on a request may run an event loop (a message box, for example), during which more requests
+// may be accepted. These are queued and acted on in turn.
+void instanceManager::processRequests()
 {
+    if( processingRequests )
+    {
+        return;
+    }
+    processingRequests = true;
+
+    while( !pendingRequests.isEmpty() )
+    {
+        pendingRequest request = pendingRequests.takeFirst();
+
+        // Identify the main window that presented the request
+        quint8 status = 0;
+        quint64 windowId = 0;
+        MainWindow* mw = newWindow( request.params );
+        if( mw )
+        {
+            status = 1;
+            windowId = quint64( mw->winId() );
+        }
+
+        // Complete the request. (The client may have gone while the window was created)
+        QByteArray ack;
+        QDataStream stream( &ack, QIODevice::WriteOnly );
+        stream.setVersion( QDataStream::Qt_5_6 );
+        stream << status << windowId << quint32( request.timer.elapsed() );
+
+        if( request.client )
+        {
+            request.client->write( buildFrame( MESSAGE_OPEN_ACK, request.requestId, ack ) );
+            request.client->flush();
+        }
+    }
+
+    processingRequests = false;
+}
+
+//------------------------------------------------------------------------------
+// Create new main windows.
+// Return the main window presenting the request - the new main window, or an existing main window
+// presenting a GUI already open. If several main windows are involved, the last is returned.
+MainWindow* instanceManager::newWindow( const startupParams& params )
+{
+    MainWindow* presentedBy = NULL;
+
     // Set up the profile for the new windows
     ContainerProfile profile;
 
@@ -158,7 +587,7 @@ void instanceManager::newWindow( const startupParams& params )
 
     // If auto save configuration is enabled, and there is an auto saved configuration,
     // then we did not shut down cleanly. Offer to restart with the auto saved configuration.
-    if( !params.disableAutoSaveConfiguration && persistanceManager->isConfigurationPresent(  params.configurationFile, QE_CONFIG_NAME, app->getAutoSaveConfigName() ) )
+    if( !params.disableAutoSaveConfiguration && configStore::isConfigurationPresent( persistanceManager, params.configurationFile, QE_CONFIG_NAME, app->getAutoSaveConfigName() ) )
     {
         QMessageBox msgBox;
         msgBox.setText( "An automatically saved configuration has been found which indicates this application was not shut down properly (or another QEGui is running using the same configuration file).\n\n Would you like to restart with the auto-saved configuration?" );
@@ -193,7 +622,8 @@ void instanceManager::newWindow( const startupParams& params )
         // Ask the persistance manager to restore a configuration.
         // The persistance manager will signal all interested objects (including this application) that
         // they should collect and apply restore data.
-        persistanceManager->restore( params.configurationFile, QE_CONFIG_NAME, configName );
+        startupTraceScope traceRestore( "restore configuration", "step", configName );
+        configStore::restore( persistanceManager, params.configurationFile, QE_CONFIG_NAME, configName );
 
         // If the restoration did not create any windows, warn the user.
         // This is especially important as an .ui file specified on the command line will now be opened,
@@ -204,6 +634,10 @@ void instanceManager::newWindow( const startupParams& params )
                                   QString( "Configuration restoration did not create any windows.\n"
                                            "Looked for configuration named '%1'.").arg( params.configurationName ) );
         }
+        else
+        {
+            presentedBy = app->getMainWindow( app->getMainWindowCount() - 1 );
+        }
     }
 
     // Not restoring, or if restoring didn't create any main windows, open the required guis
@@ -214,9 +648,14 @@ void instanceManager::newWindow( const startupParams& params )
         // If no files specified, open a single window without a file name
         if( !params.filenameList.count() )
         {
-            MainWindow* mw = new MainWindow( app, "", "", params.defaultCustomisationName,
-                                             QEFormMapper::nullHandle(),  true, NULL, NULL );
+            MainWindow* mw = takeShell( "", params.defaultCustomisationName, params );
+            if( !mw )
+            {
+                mw = new MainWindow( app, "", "", params.defaultCustomisationName,
+                                     QEFormMapper::nullHandle(),  true, NULL, NULL );
+            }
             mw->show();
+            presentedBy = mw;
         }
 
         // Files have been specified. Open a window for each of them
@@ -224,22 +663,32 @@ void instanceManager::newWindow( const startupParams& params )
         {
             for( int i = 0; i < params.filenameList.count(); i++ )
             {
-                // If there is at least one window, ask it to open the new window using the normal action request method.
-                // This is better than just creating a new window as the normal action request method will do
-                // usefull stuff like finding and presenting an existing window if it exists.
+                // If there is at least one window, ask it to open the new window using the normal gui launch method
+                // (as for an action request). This is better than just creating a new window as the normal launch
+                // method will do usefull stuff like finding and presenting an existing window if it exists.
                 if( app->getMainWindowCount() )
                 {
                    MainWindow* mw = app->getMainWindow( 0 );
-                   mw->requestAction( QEActionRequests( params.filenameList[i], params.startupCustomisationName,
-                                                        QE::NewWindow, QEFormMapper::nullHandle() ) );
+                   QWidget* w = mw->launchGui( params.filenameList[i], "", params.startupCustomisationName,
+                                               QE::NewWindow, false, QEFormMapper::nullHandle() );
+                   MainWindow* launchedBy = qobject_cast<MainWindow*>( w );
+                   if( launchedBy )
+                   {
+                       presentedBy = launchedBy;
+                   }
                 }
                 // If there are currently no windows, create one
                 else
                 {
-                    MainWindow* mw = new MainWindow( app, params.filenameList[i],
-                                                     "", params.startupCustomisationName,
-                                                     QEFormMapper::nullHandle(), true, NULL, NULL );
+                    MainWindow* mw = takeShell( params.filenameList[i], params.startupCustomisationName, params );
+                    if( !mw )
+                    {
+                        mw = new MainWindow( app, params.filenameList[i],
+                                             "", params.startupCustomisationName,
+                                             QEFormMapper::nullHandle(), true, NULL, NULL );
+                    }
                     mw->show();
+                    presentedBy = mw;
                 }
             }
         }
@@ -248,6 +697,102 @@ void instanceManager::newWindow( const startupParams& params )
     }
 
     // Release the profile
+
+    return presentedBy;
+}
+
+//------------------------------------------------------------------------------
+// Server mode.
+// Do as much as possible now so windows requested by other instances appear quickly:
+// load the designer plugins (including the QE framework plugin), pre-read any GUI
+// files specified, and start building the pool of main windows.
+// No GUIs are created in advance, as a GUI connects to its PVs as soon as it is built.
+void instanceManager::startServerMode( const startupParams& params )
+{
+    // Load the designer plugins. Listing the available widgets loads them all.
+    {
+        startupTraceScope trace( "load plugins", "step" );
+        QUiLoader loader;
+        loader.availableWidgets();
+    }
+
+    // Pre-read the GUI files. Each is resolved, which caches its resolved name, and read,
+    // which warms the file system cache (the files are often on a network file system).
+    ContainerProfile profile;
+    profile.setupProfile( NULL, params.pathList, "", params.substitutions );
+    for( int i = 0; i < params.filenameList.count(); i++ )
+    {
+        startupTraceScope trace( "pre-read", "step", params.filenameList[i] );
+
+        const QString resolvedName = app->getFormCache()->resolve( params.filenameList[i], &profile );
+        QFile uiFile( resolvedName );
+        if( resolvedName.isEmpty() || !uiFile.open( QIODevice::ReadOnly ) )
+        {
+            qDebug() << "Server mode: can't read GUI file given:" << params.filenameList[i];
+            continue;
+        }
+        uiFile.readAll();
+    }
+    profile.releaseProfile();
+
+    // Build the pool of main windows (when idle)
+    shellPoolEnabled = true;
+    shellCustomisationName = params.startupCustomisationName;
+    shellPathList = params.pathList;
+    shellSubstitutions = params.substitutions;
+    QTimer::singleShot( 0, this, SLOT( replenishShells() ) );
+}
+
+//------------------------------------------------------------------------------
+// Construct a pooled main window if the pool is not full.
+// One is constructed at a time, each when the application is next idle, so
+// requests from other instances are not held up by building the pool.
+void instanceManager::replenishShells()
+{
+    if( !shellPoolEnabled || shells.count() >= SHELL_POOL_SIZE )
+    {
+        return;
+    }
+
+    startupTraceScope trace( "construct pooled main window", "step" );
+
+    ContainerProfile profile;
+    profile.setupProfile( NULL, shellPathList, "", shellSubstitutions );
+
+    // A main window with no file name and no 'Open' dialog just applies its customisations
+    MainWindow* mw = new MainWindow( app, "", "", shellCustomisationName,
+                                     QEFormMapper::nullHandle(), false, NULL, NULL );
+
+    // Not a real main window until it is used
+    app->removeMainWindow( mw );
+    shells.append( mw );
+
+    profile.releaseProfile();
+
+    if( shells.count() < SHELL_POOL_SIZE )
+    {
+        QTimer::singleShot( 0, this, SLOT( replenishShells() ) );
+    }
+}
+
+//------------------------------------------------------------------------------
+// Take a pre-constructed main window from the pool and open a file in it.
+// The pooled main windows have the server's customisations applied, so they are
+// only used if the same customisations are required.
+MainWindow* instanceManager::takeShell( const QString& fileName, const QString& customisationName, const startupParams& params )
+{
+    if( shells.isEmpty() || customisationName != shellCustomisationName )
+    {
+        return NULL;
+    }
+
+    MainWindow* mw = shells.takeFirst();
+    mw->openInShell( fileName, customisationName, params.pathList, params.substitutions );
+
+    // Top up the pool when next idle
+    QTimer::singleShot( 0, this, SLOT( replenishShells() ) );
+
+    return mw;
 }
 
 // end
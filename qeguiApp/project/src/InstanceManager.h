@@ -17,9 +17,15 @@
 #include <QLocalSocket>
 #include <QLocalServer>
 #include <StartupParams.h>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
 #include <QObject>
+#include <QPointer>
 
 class QEGui;
+class MainWindow;
 
 class instanceManager: public QObject
 {
@@ -29,18 +35,58 @@ public:
     explicit instanceManager( QEGui* app );
     ~instanceManager();
     bool handball( startupParams* params );
-    void newWindow( const startupParams& params );
+    MainWindow* newWindow( const startupParams& params );  // Create new main windows. Returns the main window presenting the request
+    void startServerMode( const startupParams& params );   // Load plugins, pre-read files and pre-construct main windows, ready for requests from other instances
+    static QString serverNameFor( const QString& instanceName );  // Name of the instance server for an instance name (QEGUI_INSTANCE_NAME)
 
 private:
-    QLocalSocket* socket;
-    QLocalServer* server;
-    QLocalSocket* client;
+    bool serverMayBePresent();                      // Quick check (no connection attempt) for another instance
+
+    // Message framing
+    static QByteArray buildFrame( const quint8 type, const quint32 requestId, const QByteArray& body );
+    static bool takeFrame( QByteArray& buffer, quint8& type, quint32& requestId, QByteArray& body, bool& isValid );
+
+    QString serverName;                             // Name of the instance server
+    QLocalSocket* socket;                           // Connection to another instance (if any)
+    QLocalServer* server;                           // Instance server (if this is the first instance)
+    QHash<QLocalSocket*, QByteArray> clientBuffers; // Received data not yet processed, for each connected instance
+    quint32 nextRequestId;                          // Id of the next request made to another instance
+
+    // A request accepted from another instance, waiting to be acted on
+    class pendingRequest
+    {
+    public:
+        QPointer<QLocalSocket> client;              // Connection the request arrived on (NULL if since gone)
+        quint32 requestId;
+        startupParams params;
+        QElapsedTimer timer;                        // Started when the request was accepted
+    };
+    QList<pendingRequest> pendingRequests;          // Accepted requests, in the order received
+    bool processingRequests;                        // True while acting on the accepted requests
+    void processRequests();                         // Act on the accepted requests
+    QLocalSocket* probe;                            // Used to check if a server name in use belongs to a live instance
+
+    // Take a pre-constructed main window from the pool (server mode) and open a file in it.
+    // Returns NULL if no suitable main window is available.
+    MainWindow* takeShell( const QString& fileName, const QString& customisationName, const startupParams& params );
+
+    QList<MainWindow*> shells;                      // Pool of pre-constructed hidden main windows (server mode only)
+    QString shellCustomisationName;                 // Customisation applied to the pooled main windows
+    QStringList shellPathList;                      // Profile used while constructing the pooled main windows
+    QString shellSubstitutions;
+    bool shellPoolEnabled;
 
     QEGui* app;
 
 public slots:
     void connected();
     void readParams();
+
+private slots:
+    void clientDisconnected();                                  // A connected instance has gone
+    void startServer();                                         // Start the server for future instances
+    void replenishShells();                                     // Construct a pooled main window if the pool is not full
+    void probeStateChanged( QLocalSocket::LocalSocketState state ); // Result of checking for a live instance
 };
 
 #endif // QEGUI_INSTANCE_MANAGER_H
@@ -72,10 +72,20 @@
             put gui in current window
 
 
-        A new GUI may be created by calling when performing a 'restore' on a main window
-
-          MainWindow::saveRestore()
-            call MainWindow::createGui()
+        A new GUI may be created by calling when performing a 'restore' on a main window.
+        (When a restore is requested, GUIs already open are first offered for reuse, and a
+        matching GUI is moved into the restored main window rather than re-created)
+
+          QEGui::restoreConfiguration()
+            call MainWindow::releaseGuisForReuse()
+            call MainWindow::closeAll()
+            restore configuration
+              MainWindow::saveRestore()
+                either
+                  call MainWindow::reuseGui()
+                or
+                  call MainWindow::createGui()
+            delete guis not reused
 
 
         A new main window may be created by the slot supporting the 'File...' -> 'New Window' menu item
@@ -96,12 +106,17 @@
               call MainWindow::MainWindow()
 
 
-        A new window may be created by the 'Detatch Tab' in the main window's context menu:
+        A GUI may be moved, as is (it is not re-created), by the tab and dock context menus,
+        and by the 'File...' -> 'Move Form...' menu item:
 
-          MainWindow::tabContextMenuTrigger()
-            get details from appropriate tabbed GUI
-            close tabbed GUI
-            call MainWindow::MainWindow()
+          MainWindow::moveGuiMenu()
+            call MainWindow::moveGui()
+              call MainWindow::releaseGui()
+              either
+                call MainWindow::MainWindow( app, "", "", ... ) for a new window
+              or
+                use an existing main window (this one, or another)
+              call MainWindow::adoptGui()
 
 
         A new window, or a new GUI in an existing main window, may be created by the slot for
@@ -144,12 +159,16 @@
 #include <QVariant>
 #include <QScrollBar>
 #include <QFileDialog>
+#include <QLabel>
 #include <saveDialog.h>
 #include <restoreDialog.h>
 #include <PasswordDialog.h>
 #include <QEGui.h>
 #include <aboutDialog.h>
+#include <formProfileDialog.h>
 #include <macroSubstitution.h>
+#include <startupTrace.h>
+#include <configStore.h>
 
 #define DEBUG qDebug () << "MainWindow" << __LINE__ << __FUNCTION__ << "  "
 
@@ -203,9 +222,10 @@ MainWindow::MainWindow( QEGui* appIn, QString fileName, QString title,
    app = appIn;
 
    // Initialise pointers
-   tabMenu = NULL;
    windowMenu = NULL;
    recentMenu = NULL;
+   windowMenuGeneration = -1;
+   recentMenuGeneration = -1;
    editMenu = NULL;
 
    windowScaling = 1.0;
@@ -226,7 +246,7 @@ MainWindow::MainWindow( QEGui* appIn, QString fileName, QString title,
    usingTabs = false;
 
    beingDeleted = false;
-   waitForX11WindowManagerCount = 0;
+   deferPlaceholders = false;
 
    // Give the main window's UserMessage class a unique form ID so only messages from
    // the form in each main window are displayed that main window's status bar
@@ -258,6 +278,30 @@ MainWindow::MainWindow( QEGui* appIn, QString fileName, QString title,
    // Enable the status bar as required
    statusBar()->setVisible( !app->getParams()->disableStatus );
 
+   // If the repaint rate is governed, show the rate of updates in against the rate of repaints out,
+   // and if adaptive, the throttling level
+   refreshGovernor* governor = app->getRefreshGovernor();
+   if( governor->isEnabled() )
+   {
+      QLabel* rates = new QLabel( governor->getRateSummary(), this );
+      QString tip = governor->getMaxRate() > 0.0 ? QString( "PV updates received and main window repaints each second (repaints limited to %1 Hz)" ).arg( governor->getMaxRate() )
+                                                 : QString( "PV updates received and main window repaints each second" );
+      if( governor->isAdaptive() )
+      {
+         tip.append( "\nThrottling: 1 - hidden GUIs suspended, 2 - other main windows slowed, 3 - floating docks slowed, 4 - all slowed further."
+                     "\nThe window with focus is always repainted at the full rate. Refer to the 'About' dialog for details." );
+      }
+      rates->setToolTip( tip );
+      statusBar()->addPermanentWidget( rates );
+      QObject::connect( governor, SIGNAL( ratesChanged( const QString& ) ), rates, SLOT( setText( const QString& ) ) );
+
+      // When the load changes, hidden GUIs may need to be suspended or resumed
+      if( governor->isAdaptive() )
+      {
+         QObject::connect( governor, SIGNAL( loadLevelChanged( int ) ), this, SLOT( loadLevelChanged( int ) ) );
+      }
+   }
+
    // If no filename or customisation name was supplied (in other words, no indication as to how to start),
    // and an 'Open...' dialog is required, open the file selection dialog
    // Do it after the creation of the main window is complete
@@ -343,6 +387,34 @@ MainWindow::MainWindow( QEGui* appIn, QString fileName, QString title,
    }
 }
 
+// Open a file in a pre-constructed main window.
+// In server mode a small pool of main windows is constructed (hidden, and not in the application's
+// list of main windows) before they are needed. This takes one of those into use for a new window.
+// The file is then opened exactly as for a new main window, or if none, the 'Open' dialog is presented.
+void MainWindow::openInShell( QString fileName, QString customisationName,
+                              const QStringList& pathList, const QString& macroSubstitutions )
+{
+   // The shell was built with the server's profile. Use the profile of the new window.
+   profile.setupLocalProfile( profile.getGuiLaunchConsumer(), pathList, profile.getParentPath(), macroSubstitutions );
+
+   // Now a real main window
+   app->addMainWindow( this );
+
+   if( fileName.isEmpty() )
+   {
+      QTimer::singleShot( 0, this, SLOT(onOpenRequested()));
+      return;
+   }
+
+   QEForm* gui = createGui( fileName, "", customisationName, QEFormMapper::nullHandle() );
+   // Enable ui file monitoring if and only enableEdit requested.
+   if( gui )
+   {
+      gui->setFileMonitoringIsEnabled( app->getParams()->enableEdit );
+   }
+   loadGuiIntoCurrentWindow( gui, true );
+}
+
 // Destructor
 MainWindow::~MainWindow()
 {
@@ -352,6 +424,13 @@ MainWindow::~MainWindow()
    // Remove the GUIs shown in this main window from the GUIs listed in the 'Windows' menus of all other main windows
    removeAllGuisFromGuiList();
 
+   // Placeholders (lazy restore) are about to be deleted along with this window
+   for( int i = 0; i < placeholders.count(); i++ )
+   {
+      QObject::disconnect( placeholders[i], SIGNAL( destroyed( QObject* ) ), this, SLOT( placeholderDestroyed( QObject* ) ) );
+   }
+   placeholders.clear();
+
    // Remove this main window from the global list of main windows
    // Note, this may have already been done to hide the the main window if deleting using deleteLater()
    app->removeMainWindow( this );
@@ -393,10 +472,12 @@ void MainWindow::setupPlaceholderMenus()
    if( windowMenu )
    {
       windowMenu->clear();
+      QObject::disconnect( windowMenu, SIGNAL( aboutToShow() ), this, SLOT( windowMenuAboutToShow() ) );
    }
    if( recentMenu )
    {
       recentMenu->clear();
+      QObject::disconnect( recentMenu, SIGNAL( aboutToShow() ), this, SLOT( recentMenuAboutToShow() ) );
    }
 
    windowMenu = customisationInfo.placeholderMenus.value( "Windows", NULL );
@@ -414,11 +495,19 @@ void MainWindow::setupPlaceholderMenus()
       editMenu->setEnabled( app->getParams()->enableEdit  );
    }
 
-   // Populate the 'Windows' menu to include all current guis in any main window
-   buildWindowsMenu();
+   // The 'Windows' and 'Recent...' menus are populated when about to be shown, and only if the
+   // application's list of guis or recent files has changed since the menu was last populated.
+   windowMenuGeneration = -1;
+   if( windowMenu )
+   {
+      QObject::connect( windowMenu, SIGNAL( aboutToShow() ), this, SLOT( windowMenuAboutToShow() ) );
+   }
 
-   // Populate the 'Recent...' menu to include recent guis
-   buildRecentMenu();
+   recentMenuGeneration = -1;
+   if( recentMenu )
+   {
+      QObject::connect( recentMenu, SIGNAL( aboutToShow() ), this, SLOT( recentMenuAboutToShow() ) );
+   }
 }
 
 //=================================================================================
@@ -541,7 +630,7 @@ void MainWindow::on_actionClose_triggered()
       // (Create an empty central widget)
       QEForm* gui = getCentralGui();
       caQtDmInterface->sendCloseEvent(gui);
-      if( gui )
+      if( gui && !cacheClosedGui( gui ) )
       {
          removeGuiFromGuiList( gui );
          setCentralWidget( new QWidget() );
@@ -661,7 +750,9 @@ void MainWindow::closeEvent(QCloseEvent *event)
    }
 
    // If this is the last main window, the application is about to exit, so finalise auto-save configuration.
-   if( app->getMainWindowCount() == 1 )
+   // (Unless running in server mode, in which case the application keeps running)
+   const bool exiting = app->getMainWindowCount() == 1 && !app->getParams()->serverMode;
+   if( exiting )
    {
       app->stopAutoSaveConfig();
    }
@@ -695,6 +786,15 @@ void MainWindow::closeEvent(QCloseEvent *event)
             break;
       }
    }
+
+   // If closed guis are being kept for reopening, keep this window's guis (unless the application is exiting)
+   if( event->isAccepted() && !exiting && app->getClosedFormCache()->isEnabled() )
+   {
+      while( !guiList.isEmpty() )
+      {
+         cacheClosedGui( guiList.last().getForm() );
+      }
+   }
 }
 
 // Exit.
@@ -967,11 +1067,35 @@ void MainWindow::on_actionAbout_triggered()
                   app->getCustomisationLog(),                            // Log of window customisations
 
                   disconnectedCount,                                     // Disconnection count
-                  connectedCount                                         // Connection count
+                  connectedCount,                                        // Connection count
+
+                  app->getPerformanceReport()                            // Performance statistics
                   );
    ad.exec( this );
 }
 
+// Present the costs accumulated by the form profiler
+void MainWindow::on_actionForm_Cost_Profile_triggered()
+{
+   formProfileDialog* fpd = new formProfileDialog( app, this );
+   fpd->setAttribute( Qt::WA_DeleteOnClose );
+   fpd->show();
+}
+
+// Move the current gui (without reloading it) to a tab, dock, or another main window
+void MainWindow::on_actionMove_Form_triggered()
+{
+   moveGuiMenu( getCurrentGui(), QCursor::pos() );
+}
+
+// Turn form profiling on or off
+void MainWindow::on_actionForm_Profiling_triggered()
+{
+   const bool profiling = !app->getFormProfiler()->isEnabled();
+   app->setFormProfiling( profiling );
+   newMessage( QString( "Form profiling %1" ).arg( profiling ? "on" : "off" ), message_types ( MESSAGE_TYPE_INFO ) );
+}
+
 // Change the current tab
 void MainWindow::tabCurrentChanged( int index )
 {
@@ -979,12 +1103,127 @@ void MainWindow::tabCurrentChanged( int index )
    if( !usingTabs )
       return;
 
-   // Update the main window title
    QTabWidget* tabs = getCentralTabs();
+
+   // If the tab is a placeholder for a gui not yet created (lazy restore), create the gui now
+   if( tabs && !deferPlaceholders )
+   {
+      guiPlaceholder* placeholder = qobject_cast<guiPlaceholder*>( tabs->widget( index ) );
+      if( placeholder )
+      {
+         index = replacePlaceholderTab( tabs, index, placeholder );
+      }
+   }
+
+   // The current tab is saved
+   app->markConfigurationChanged();
+
+   // Update the main window title
    if( tabs )
    {
       setTitle( tabs->tabText( index ) );
    }
+
+   // Guis in other tabs can't be seen
+   updateFormVisibility();
+}
+
+// Create the gui a placeholder stands for (lazy restore).
+// The gui is created under the path list and macro substitutions it would have been restored with.
+QEForm* MainWindow::createPlaceholderGui( guiPlaceholder* placeholder, bool isDock )
+{
+   const QStringList windowPathList = profile.getPathList();
+   const QString windowMacroSubstitutions = profile.getMacroSubstitutions();
+
+   profile.releaseProfile();
+   profile.setupLocalProfile( profile.getGuiLaunchConsumer(), placeholder->pathList, profile.getParentPath(), placeholder->macroSubstitutions );
+   profile.publishOwnProfile();
+
+   QEForm* gui = createGui( placeholder->fileName, placeholder->title, placeholder->customisationName,
+                            QEFormMapper::nullHandle(), placeholder->restoreId, isDock );
+
+   profile.releaseProfile();
+   profile.setupLocalProfile( profile.getGuiLaunchConsumer(), windowPathList, profile.getParentPath(), windowMacroSubstitutions );
+
+   // The placeholder is no longer needed (or saved)
+   placeholders.removeOne( placeholder );
+
+   return gui;
+}
+
+// Replace a placeholder tab with the gui it stands for (lazy restore).
+// Return the index of the tab now holding the gui.
+int MainWindow::replacePlaceholderTab( QTabWidget* tabs, int index, guiPlaceholder* placeholder )
+{
+   QEForm* gui = createPlaceholderGui( placeholder, false );
+   if( !gui )
+   {
+      // Leave the placeholder where it is, but don't try again
+      return index;
+   }
+
+   // Swap the placeholder for the gui without acting on the intermediate tab changes
+   deferPlaceholders = true;
+   QWidget* rGui = resizeableGui( gui );
+   tabs->insertTab( index, rGui, gui->getQEGuiTitle() );
+   tabs->removeTab( tabs->indexOf( placeholder ) );
+   tabs->setCurrentWidget( rGui );
+   deferPlaceholders = false;
+
+   // Apply the scroll position restored with the placeholder
+   if( placeholder->hasScroll )
+   {
+      guiList.last().setScroll( placeholder->scroll );
+      QScrollArea* sa = guiScrollArea( gui );
+      if( sa )
+      {
+         sa->horizontalScrollBar()->setValue( placeholder->scroll.x() );
+         sa->verticalScrollBar()->setValue( placeholder->scroll.y() );
+      }
+   }
+
+   placeholder->deleteLater();
+
+   // Initialise customisation items.
+   app->getMainWindowCustomisations()->initialise( &customisationInfo );
+
+   return tabs->indexOf( rGui );
+}
+
+// A dock has been shown or hidden.
+// If it holds a placeholder for a gui not yet created (lazy restore), create the gui now.
+// (If the gui can't be created, this is tried again next time the dock is shown)
+void MainWindow::dockVisibilityChanged( bool visible )
+{
+   // A gui in a hidden dock can't be seen
+   updateFormVisibility();
+
+   if( !visible || deferPlaceholders )
+   {
+      return;
+   }
+
+   QDockWidget* dock = qobject_cast<QDockWidget*>( sender() );
+   guiPlaceholder* placeholder = dock ? qobject_cast<guiPlaceholder*>( dock->widget() ) : NULL;
+   if( !placeholder )
+   {
+      return;
+   }
+
+   QEForm* gui = createPlaceholderGui( placeholder, true );
+   if( gui )
+   {
+      dock->setWidget( resizeableGui( gui ) );
+      dock->setWindowTitle( gui->getQEGuiTitle() );
+      placeholder->deleteLater();
+   }
+}
+
+// A placeholder has gone away (replaced by its gui, or its tab, dock or main window has been closed)
+void MainWindow::placeholderDestroyed( QObject* placeholder )
+{
+   // Only the pointer value is used, the object is no longer a guiPlaceholder
+   placeholders.removeOne( static_cast<guiPlaceholder*>( placeholder ) );
 }
 
 // Delete a tab
@@ -994,11 +1233,27 @@ void MainWindow::tabCloseRequest( int index )
    if( !tabs )
       return;
 
+   // If the tab is a placeholder for a gui not yet created (lazy restore), just remove it
+   guiPlaceholder* placeholder = qobject_cast<guiPlaceholder*>( tabs->widget( index ) );
+   if( placeholder )
+   {
+      tabs->removeTab( index );
+      placeholder->deleteLater();
+      if( tabs->count() == 1 )
+         setSingleMode();
+      return;
+   }
+
    // Get a reference to the scroll area for the tab being deleted
    tabs->setCurrentIndex( index );
    QEForm* gui = extractGui( tabs->currentWidget() );
 
    caQtDmInterface->sendCloseEvent (gui);
+
+   // If closed guis are being kept for reopening, keep the gui (this also removes its tab)
+   if( gui && cacheClosedGui( gui ) )
+      return;
+
    // Remove the gui from the 'windows' menus
    removeGuiFromGuiList( gui );
 
@@ -1016,7 +1271,7 @@ void MainWindow::tabContextMenuRequest( const QPoint& posIn )
    QTabWidget* tabs = getCentralTabs();
 
    // Sanity checks ....
-   if (!usingTabs || !tabs || !tabMenu) {
+   if (!usingTabs || !tabs) {
       return;
    }
 
@@ -1043,66 +1298,308 @@ void MainWindow::tabContextMenuRequest( const QPoint& posIn )
    if (index >= 0) {
       tabs->setCurrentIndex (index);
       golbalPos = tabs->mapToGlobal (posIn);
-      tabMenu->exec (golbalPos, 0);
+
+      // Offer to move the gui in the tab (placeholders for guis not yet created are left where they are)
+      QEForm* gui = extractGui( tabs->currentWidget() );
+      if( gui ) {
+         moveGuiMenu( gui, golbalPos );
+      }
    }
 }
 
-// Process context menu action.
-// Currently there is only one action - detach - no need to use the action parameter.
-void MainWindow::tabContextMenuTrigger( QAction* )
+// Process a context menu request on a dock.
+// Offer to move the gui in the dock.
+void MainWindow::dockContextMenuRequest( const QPoint& pos )
 {
-   QTabWidget* tabs = getCentralTabs();
+   QDockWidget* dock = qobject_cast<QDockWidget*>( sender() );
+   if( !dock || !dock->widget() )
+   {
+      return;
+   }
 
-   // Sanity checks ....
-   if (!tabs  || !usingTabs) {
+   QEForm* gui = extractGui( dock->widget() );
+   if( gui )
+   {
+      moveGuiMenu( gui, dock->mapToGlobal( pos ) );
+   }
+}
+
+// Present the ways a gui may be moved, and move it as the user chooses.
+// A tabbed gui may be detached to a new window or moved to a dock, a docked gui
+// may be moved to a tab, and any gui may be moved to another main window as a tab or dock.
+void MainWindow::moveGuiMenu( QEForm* gui, const QPoint& globalPos )
+{
+   if( !gui )
+   {
       return;
    }
 
-   int index = tabs->currentIndex ();
+   // Where is the gui now?
+   QTabWidget* tabs = getCentralTabs();
+   const bool inDock = getGuiDock( gui ) != NULL;
+   const bool inTab = !inDock && tabs && tabs->isAncestorOf( gui );
+
+   QMenu menu( this );
+   QAction* newWindowAction = menu.addAction( "Detach to new window" );
+   newWindowAction->setEnabled( inDock || inTab );
+   QAction* tabAction = menu.addAction( "Move to tab" );
+   tabAction->setEnabled( inDock );
+   QAction* dockAction = menu.addAction( "Move to floating dock" );
+   dockAction->setEnabled( inTab );
+
+   // Offer each other main window, as a tab or a dock
+   QMenu* windowsMenu = menu.addMenu( "Move to window" );
+   QHash<QAction*, MainWindow*> targets;
+   QList<QAction*> dockTargets;
+   for( int i = 0; i < app->getMainWindowCount(); i++ )
+   {
+      MainWindow* mw = app->getMainWindow( i );
+      if( mw == this )
+      {
+         continue;
+      }
 
-   // Similar to tab close request
-   QEForm* gui = extractGui( tabs->currentWidget() );
+      QMenu* targetMenu = windowsMenu->addMenu( mw->windowTitle() );
+      QAction* action = targetMenu->addAction( "As tab" );
+      targets.insert( action, mw );
+      action = targetMenu->addAction( "As dock" );
+      targets.insert( action, mw );
+      dockTargets.append( action );
+   }
+   windowsMenu->setEnabled( !targets.isEmpty() );
 
-   if (!gui) {
+   QAction* chosen = menu.exec( globalPos );
+   if( !chosen )
+   {
       return;
    }
 
-   // Extract and save the filename.
-   QString fileName = gui->getFullFileName ();
+   if( chosen == newWindowAction )
+   {
+      moveGui( gui, NULL, QE::Open );
+   }
+   else if( chosen == tabAction )
+   {
+      moveGui( gui, this, QE::NewTab );
+   }
+   else if( chosen == dockAction )
+   {
+      moveGui( gui, this, QE::DockFloating );
+   }
+   else if( targets.contains( chosen ) )
+   {
+      // Ensure the main window is still present (it may have closed while the menu was open)
+      MainWindow* target = targets.value( chosen );
+      if( app->getMainWindowPosition( target ) >= 0 )
+      {
+         moveGui( gui, target, dockTargets.contains( chosen ) ? QE::DockFloating : QE::NewTab );
+      }
+   }
+}
+
+// Move a gui to another main window (or a new main window if target is NULL), or elsewhere in this main window.
+// The gui is moved as is, with its scroll area, PV connections and state. Nothing is re-created or reconnected.
+// If this main window is left with no guis it is closed.
+void MainWindow::moveGui( QEForm* gui, MainWindow* target, QE::CreationOptions createOption )
+{
+   if( !gui )
+   {
+      return;
+   }
 
-   // Extract and save the title.
-   // This is required as the title may have been set by this application, and not
-   // generated by the QEForm, so the current title needs to be saved and applied when re-creating it.
-   QString title = gui->getFullFileName ();
+   QString customisationName = getCustomisationName( gui );
+   QWidget* rGui = releaseGui( gui );
 
-   // Look for the GUI and save the window customisation name if found
-   QString customisationName;
-   for( int i = 0; i < guiList.count(); i++ )
+   // Create a new main window if required. (It is created empty, with the gui's customisations)
+   bool newWindow = false;
+   if( !target )
    {
-      if( guiList[i].getForm() == gui )
+      profile.publishOwnProfile();
+      target = new MainWindow( app, "", "", customisationName,
+                               QEFormMapper::nullHandle(), false, this, NULL );
+      profile.releaseProfile();
+      createOption = QE::Open;
+      newWindow = true;
+   }
+
+   target->adoptGui( gui, rGui, this, customisationName, createOption );
+
+   if( newWindow )
+   {
+      target->show();
+   }
+   else
+   {
+      target->showGui( gui );
+   }
+
+   // Let the application know which guis can now be seen
+   updateFormVisibility();
+
+   // If nothing is left in this main window, close it
+   if( target != this && guiList.isEmpty() && placeholders.isEmpty() )
+   {
+      close();
+   }
+}
+
+// Take a gui out of this main window without deleting it, so it can be moved elsewhere.
+// Return the widget holding the gui (the gui itself, or the scroll area it is in) with no parent.
+QWidget* MainWindow::releaseGui( QEForm* gui )
+{
+   // The widget holding the gui is the scroll area added by this application, if any
+   QScrollArea* sa = guiScrollArea( gui );
+   QWidget* rGui = sa ? (QWidget*)sa : (QWidget*)gui;
+
+   // Remove the gui from the 'windows' menus, and stop tracking it
+   removeGuiFromGuiList( gui );
+   QObject::disconnect( gui, SIGNAL( destroyed( QObject* )), this, SLOT( guiDestroyed( QObject* )) );
+   if( sa )
+   {
+      QObject::disconnect( sa->horizontalScrollBar(), SIGNAL( valueChanged( int ) ), this, SLOT( layoutChanged() ) );
+      QObject::disconnect( sa->verticalScrollBar(), SIGNAL( valueChanged( int ) ), this, SLOT( layoutChanged() ) );
+   }
+
+   QDockWidget* dock = getGuiDock( gui );
+   QTabWidget* tabs = getCentralTabs();
+   int index = tabs ? tabs->indexOf( rGui ) : -1;
+
+   // Remove the gui from its dock, and discard the dock
+   if( dock )
+   {
+      rGui->setParent( NULL );
+      windowCustomisationList::dockMap::iterator it = dockedComponents.begin();
+      while( it != dockedComponents.end() )
       {
-         customisationName = guiList[i].getCustomisationName();
-         break;
+         if( it.value() == dock )
+         {
+            it = dockedComponents.erase( it );
+         }
+         else
+         {
+            ++it;
+         }
       }
+      dock->deleteLater();
    }
 
-   // Remove the gui from the 'windows' menus
-   caQtDmInterface->sendCloseEvent (gui);
-   removeGuiFromGuiList( gui );
+   // Remove the gui's tab. If there is no need for tabs (only one GUI) stop using tabs
+   else if( index >= 0 )
+   {
+      tabs->removeTab( index );
+      rGui->setParent( NULL );
+      if( tabs->count() == 1 )
+      {
+         setSingleMode();
+      }
+   }
 
-   // Remove the tab - note this does not delete the page widget.
-   tabs->removeTab( index );
+   // Remove the gui from the centre of the main window, leaving it empty
+   else if( centralWidget() == rGui )
+   {
+      takeCentralWidget();
+      rGui->setParent( NULL );
+      setCentralWidget( new QWidget );
+   }
 
-   // If there is no need for tabs (only one GUI) stop using tabs
-   if( tabs->count() == 1 )
-      setSingleMode();
+   app->markConfigurationChanged();
+   return rGui;
+}
 
-   // Use extracted filename to open the new window - we assume the file still exists.
-   profile.publishOwnProfile();
-   MainWindow* w = new MainWindow( app, fileName, title, customisationName,
-                                  QEFormMapper::nullHandle(), false, this, NULL );
-   profile.releaseProfile();
-   w->show();
+// Take in a gui released by a main window (this one or another).
+// The gui is added to this main window as is, in its scroll area if it has one.
+// If the gui is to be opened in this main window (QE::Open) and the window already has a gui, it is added in a new tab.
+void MainWindow::adoptGui( QEForm* gui, QWidget* rGui, MainWindow* from,
+                          QString customisationName, QE::CreationOptions createOption )
+{
+   // Send requests from the gui's widgets, and scroll position changes, to this main window
+   if( from && from != this )
+   {
+      redirectGuiRequests( gui, from );
+   }
+   QScrollArea* sa = qobject_cast<QScrollArea*>( rGui );
+   if( sa )
+   {
+      QObject::connect( sa->horizontalScrollBar(), SIGNAL( valueChanged( int ) ), this, SLOT( layoutChanged() ) );
+      QObject::connect( sa->verticalScrollBar(), SIGNAL( valueChanged( int ) ), this, SLOT( layoutChanged() ) );
+   }
+
+   // A gui can only be opened as the main window's only gui if it has none
+   if( createOption == QE::Open && ( usingTabs || getCentralGui() ) )
+   {
+      createOption = QE::NewTab;
+   }
+
+   // Likewise, a gui need only be tabbed if there is another gui in the centre of the main window
+   if( createOption == QE::NewTab && !usingTabs && !getCentralGui() )
+   {
+      createOption = QE::Open;
+   }
+
+   const bool isDock = ( createOption != QE::Open && createOption != QE::NewTab );
+   addGuiToGuiList( gui, customisationName, isDock );
+
+   switch( createOption )
+   {
+      // Make the gui the only gui in the main window, and size the main window to fit it
+      case QE::Open:
+         if( centralWidget() )
+         {
+            centralWidget()->setFixedSize( rGui->size() );
+            adjustSize();
+         }
+         setCentralWidget( rGui );
+         rGui->show();
+         setTitle( gui->getQEGuiTitle() );
+         app->getMainWindowCustomisations()->initialise( &customisationInfo );
+         break;
+
+      // Add the gui in a new tab
+      case QE::NewTab:
+         {
+            if( !usingTabs )
+               setTabMode();
+
+            QTabWidget* tabs = getCentralTabs();
+            if( tabs )
+            {
+               int index = tabs->addTab( rGui, gui->getQEGuiTitle() );
+               tabs->setCurrentIndex( index );
+               rGui->show();
+            }
+            app->getMainWindowCustomisations()->initialise( &customisationInfo );
+         }
+         break;
+
+      // Add the gui in a new dock
+      default:
+         loadWidgetIntoNewDock( rGui, gui->getQEGuiTitle(), false, createOption,
+                                Qt::AllDockWidgetAreas, QDockWidget::DockWidgetFeatureMask,
+                                QRect( QPoint( 0, 0 ), rGui->size() ) );
+         rGui->show();
+         break;
+   }
+
+   updateFormVisibility();
+}
+
+// Widgets in a gui send requests (to launch other guis, for example) to the main window that created the gui.
+// When a gui has moved to this main window from another, send them here instead.
+void MainWindow::redirectGuiRequests( QEForm* gui, MainWindow* from )
+{
+   QList<QObject*> objects = gui->findChildren<QObject*>();
+   objects.prepend( gui );
+   for( int i = 0; i < objects.count(); i++ )
+   {
+      QObject* object = objects[i];
+      if( object->metaObject()->indexOfSignal( "requestAction(QEActionRequests)" ) >= 0 &&
+          QObject::disconnect( object, SIGNAL( requestAction( const QEActionRequests& ) ),
+                               from, SLOT( requestAction( const QEActionRequests& ) ) ) )
+      {
+         QObject::connect( object, SIGNAL( requestAction( const QEActionRequests& ) ),
+                           this, SLOT( requestAction( const QEActionRequests& ) ) );
+      }
+   }
 }
 
 // Open designer
@@ -1199,6 +1696,11 @@ void MainWindow::on_actionRefresh_Current_Form_triggered()
    // Recreate the gui and load it in place of the current window
    if( guiFileName.size() )
    {
+      // The user expects the file to be read afresh (and not reopened from any closed guis kept for reopening)
+      app->getFormCache()->invalidate( currentGui->getFullFileName() );
+      app->getClosedFormCache()->invalidate( currentGui->getFullFileName() );
+      app->getFormIndex()->invalidatePaths();
+
       profile.publishOwnProfile();
       QEForm* newGui = createGui( guiPath, "", "", currentHandle); // no customisation name so customisations remain unaltered
       loadGuiIntoCurrentWindow( newGui, true );
@@ -1248,9 +1750,18 @@ QWidget* MainWindow::resizeableGui( QEForm* gui, QSize* preferedSize )
    // If the widget is not managing its own size return it within a scroll area
    else
    {
-      // Add the gui to a scroll area
-      QScrollArea* sa = new QScrollArea();
-      sa->setWidget( gui );
+      // Add the gui to a scroll area.
+      // If the gui is being reused it will still be in the scroll area it was released from, so use that.
+      QScrollArea* sa = guiScrollArea( gui );
+      if( !sa || sa->parentWidget() )
+      {
+         sa = new QScrollArea();
+         sa->setWidget( gui );
+      }
+
+      // The scroll position is saved, so note when it changes
+      QObject::connect( sa->horizontalScrollBar(), SIGNAL( valueChanged( int ) ), this, SLOT( layoutChanged() ) );
+      QObject::connect( sa->verticalScrollBar(), SIGNAL( valueChanged( int ) ), this, SLOT( layoutChanged() ) );
 
       // Set the prefered size to the gui size plus the scroll area margins.
       if( preferedSize )
@@ -1420,13 +1931,37 @@ QDockWidget* MainWindow::loadGuiIntoNewDock( QEForm* gui,
       geom.setSize( preferedSize );
    }
 
+   return loadWidgetIntoNewDock( rGui, gui->getQEGuiTitle(), hidden, createOption, allowedAreas, features, geom );
+}
 
+// Load a widget into a new dock.
+// The widget is a resizeable gui, or when restoring lazily, a placeholder for a gui not yet created.
+QDockWidget* MainWindow::loadWidgetIntoNewDock( QWidget* widget, QString title,
+                                               bool hidden,
+                                               QE::CreationOptions createOption,
+                                               Qt::DockWidgetArea allowedAreas,
+                                               QDockWidget::DockWidgetFeature features,
+                                               QRect geom )
+{
    QDockWidget *dock = new QDockWidget( this );
    dock->setAllowedAreas( allowedAreas );
    dock->setFeatures( features );
 
+   // The dock layout is saved, so note when it changes
+   dock->installEventFilter( this );
+   QObject::connect( dock, SIGNAL( topLevelChanged( bool ) ), this, SLOT( layoutChanged() ) );
+   QObject::connect( dock, SIGNAL( dockLocationChanged( Qt::DockWidgetArea ) ), this, SLOT( layoutChanged() ) );
+   QObject::connect( dock, SIGNAL( visibilityChanged( bool ) ), this, SLOT( layoutChanged() ) );
 
-   Qt::DockWidgetArea dockLocation = creationOptionToDockLocation( createOption );
+   // Create a placeholder's gui when the dock is first shown (lazy restore),
+   // and let the application know when the gui in the dock can't be seen
+   QObject::connect( dock, SIGNAL( visibilityChanged( bool ) ), this, SLOT( dockVisibilityChanged( bool ) ) );
+
+   // Offer to move the gui in the dock elsewhere
+   dock->setContextMenuPolicy( Qt::CustomContextMenu );
+   QObject::connect( dock, SIGNAL( customContextMenuRequested( const QPoint& ) ), this, SLOT( dockContextMenuRequest( const QPoint& ) ) );
+
+   Qt::DockWidgetArea dockLocation = creationOptionToDockLocation( createOption );
 
 
    // Set the dock geometry
@@ -1461,9 +1996,9 @@ QDockWidget* MainWindow::loadGuiIntoNewDock( QEForm* gui,
    }
 
    // Load the GUI into the dock
-   dock->setWidget( rGui );
+   dock->setWidget( widget );
 
-   dock->setWindowTitle( gui->getQEGuiTitle() );
+   dock->setWindowTitle( title );
 
    // Set floating if requested
    dock->setFloating( createOption == QE::DockFloating);
@@ -1557,12 +2092,13 @@ QWidget* MainWindow::launchGui( QString guiName, QString title, QString customis
    // Get the profile published by whatever is launching a new GUI (probably a QEPushButton)
    ContainerProfile publishedProfile;
 
-   // Get a standard absolute path for the file name
-   QFile* uiFile =  QEWidget::findQEFile( guiName, &publishedProfile );
+   // Get a standard absolute path for the file name.
+   // (Resolved names are remembered, so the path list is not searched on every launch)
+   const QString uiFileName = app->getFormCache()->resolve( guiName, &publishedProfile );
 
    // If a unique new window is not implied and a file was found, check if it is the same as any already open.
    // (if the caller has specified a handle then it is assumed they want their own new unique window, not an existing one)
-   if( formHandle == QEFormMapper::nullHandle() && uiFile )
+   if( formHandle == QEFormMapper::nullHandle() && !uiFileName.isEmpty() )
    {
 
           //!!! Note, repeated substitutions should be removed leaving only the first
@@ -1571,10 +2107,9 @@ QWidget* MainWindow::launchGui( QString guiName, QString title, QString customis
       // If the form already exists (with the same substitutions), just display that one.
       // If a main window can be found with the same title, display that.
       // Note, even if the gui is found, if the main window is not located and raised, then a new gui will be launched.
-      MainWindow* mw = app->raiseGui( uiFile->fileName(), publishedProfile.getMacroSubstitutions().trimmed(), title );
+      MainWindow* mw = app->raiseGui( uiFileName, publishedProfile.getMacroSubstitutions().trimmed(), title );
       if( mw )
       {
-         delete uiFile;
          return mw;
       }
    }
@@ -1613,7 +2148,17 @@ QWidget* MainWindow::launchGui( QString guiName, QString title, QString customis
             // Note, profile should have been published by signal code
             MainWindow* w = new MainWindow( app, guiName, title, customisationName,
                                            formHandle, true, this, NULL );
-            w->show();
+
+            // If launching a number of guis together, show all new windows together when they have all been launched
+            launchBatch* batch = app->getLaunchBatch();
+            if( batch->isActive() )
+            {
+               batch->deferShow( w );
+            }
+            else
+            {
+               w->show();
+            }
             return w;
          }
 
@@ -1719,9 +2264,13 @@ void  MainWindow::requestAction( const QEActionRequests & request )
 
       case QEActionRequests::KindOpenFiles:
          {
-            // Create all the windows requested
+            // Create all the windows requested.
+            // They are launched as a single transaction (see launchBatch.h) so customisations are applied once
+            // per main window, and all windows are shown together when all have been launched.
             QList<windowCreationListItem> windows = request.getWindows();
             MainWindow* mw = this;
+            launchBatch* batch = app->getLaunchBatch();
+            batch->begin( this );
             for( int i = 0; i < windows.count(); i ++ )
             {
                // Get the next window to create and set up the profile
@@ -1759,6 +2308,7 @@ void  MainWindow::requestAction( const QEActionRequests & request )
                }
                profile.removePriorityMacroSubstitutions();
             }
+            batch->end();
          }
          break;
 
@@ -1795,6 +2345,7 @@ void  MainWindow::requestAction( const QEActionRequests & request )
             else if (action == "Screen Capture..."                 ) { on_actionScreenCapture_triggered();                  }
             else if (action == "Save Configuration..."             ) { on_actionSave_Configuration_triggered();             }
             else if (action == "Restore Configuration..."          ) { on_actionRestore_Configuration_triggered();          }
+            else if (action == "Switch Workspace..."               ) { on_actionSwitch_Workspace_triggered();               }
             else if (action == "Manage Configuration..."           ) { on_actionManage_Configurations_triggered();          }
             else if (action == "User Level..."                     ) { on_actionUser_Level_triggered();                     }
             else if (action == "Exit"                              ) { on_actionExit_triggered();                           }
@@ -1803,6 +2354,9 @@ void  MainWindow::requestAction( const QEActionRequests & request )
             else if (action == "Refresh Current Form"              ) { on_actionRefresh_Current_Form_triggered();           }
             else if (action == "Set Passwords..."                  ) { on_actionSet_Passwords_triggered();                  }
             else if (action == "About..."                          ) { on_actionAbout_triggered();                          }
+            else if (action == "Form Cost Profile..."              ) { on_actionForm_Cost_Profile_triggered();              }
+            else if (action == "Form Profiling On/Off"             ) { on_actionForm_Profiling_triggered();                 }
+            else if (action == "Move Form..."                      ) { on_actionMove_Form_triggered();                      }
             else {
                sendMessage( "Unhandled gui action request, action = '" + action + "'",
                            message_types( MESSAGE_TYPE_ERROR, MESSAGE_KIND_EVENT ) );
@@ -1958,7 +2512,6 @@ void MainWindow::setSingleMode()
 
    // Flag tabs are no longer in use
    usingTabs = false;
-   tabMenu = NULL;
 }
 
 // Set up to use multiple guis in tabs
@@ -1975,23 +2528,12 @@ void MainWindow::setTabMode()
    QObject::connect( tabs, SIGNAL( tabCloseRequested ( int ) ), this, SLOT( tabCloseRequest( int ) ) );
    QObject::connect( tabs, SIGNAL( currentChanged ( int ) ), this, SLOT( tabCurrentChanged( int ) ) );
 
-   // Set up tab context menus.
+   // Set up tab context menus (offering to move the gui in the tab).
    //
    tabs->setContextMenuPolicy (Qt::CustomContextMenu);
    QObject::connect (tabs, SIGNAL (customContextMenuRequested (const QPoint &)),
                     this, SLOT   (tabContextMenuRequest      (const QPoint &)));
 
-   tabMenu = new QMenu (tabs);  // note: menu deleted when tabs object deleted.
-
-   QAction *action = new QAction ("Reopen tab as new window", tabMenu);
-   action->setCheckable (false);
-   action->setData (QVariant (0));
-   action->setEnabled (true);
-   tabMenu->addAction (action);
-
-   QObject::connect (tabMenu, SIGNAL (triggered             (QAction* )),
-                    this,    SLOT   (tabContextMenuTrigger (QAction* )));
-
 
    // If there was a single gui present, move it to the first tab
    QEForm* gui = getCentralGui();
@@ -2033,9 +2575,18 @@ QEForm* MainWindow::createGui( QString fileName, QString title, QString customis
 {
    QEForm* gui = NULL; // New GUI created (if any).
 
-   // Only attempt to create a GUI if a filename was supplied
+   // Reopen a recently closed gui with the same .ui file and macro substitutions if one is kept
    if( !fileName.isEmpty() )
    {
+      gui = reopenGui( fileName, restoreId, formHandle );
+   }
+
+   // Only attempt to create a GUI if a filename was supplied (and no closed gui was reopened)
+   if( !gui && !fileName.isEmpty() )
+   {
+      // Record the creation time if tracing startup
+      startupTraceScope traceCreate( "createGui", "form", fileName );
+
       // Publish the main window's form Id so the new QEForm will pick it up
       setChildFormId( getNextMessageFormId() );
       profile.setPublishedMessageFormId( getChildFormId() );
@@ -2075,7 +2626,13 @@ QEForm* MainWindow::createGui( QString fileName, QString title, QString customis
       profile.updateConsumers( this );
 
       // Load the .ui file into the GUI. The QEForm object applies any scaling.
-      gui->readUiFile();
+      {
+         startupTraceScope traceRead( "readUiFile", "form", fileName );
+         gui->readUiFile();
+      }
+
+      // Profile the cost of the gui's widgets if requested
+      app->getFormProfiler()->addForm( gui );
 
       // Save the version of the QE framework used by the ui loader.
       // (can be different to the one this application is linked against)
@@ -2090,25 +2647,18 @@ QEForm* MainWindow::createGui( QString fileName, QString title, QString customis
       gui->setFormHandle (formHandle);
    }
 
-   // Perform tasks required by a main window, but not a dock
+   // Perform tasks required by a main window, but not a dock.
+   // If launching a number of guis together, apply the customisation once when they have all been launched.
    if( !isDock )
    {
-      // Use the default customisations if no customisation is specified
-      if( customisationName.isEmpty() )
+      launchBatch* batch = app->getLaunchBatch();
+      if( batch->isActive() )
       {
-         setDefaultCustomisation();
+         batch->deferCustomisation( this, customisationName );
       }
-
-      // Load any required window customisation
-      app->getMainWindowCustomisations()->applyCustomisation( this, customisationName, &customisationInfo, dockedComponents );
-
-      // Use whatever placeholder menus are available (for example, populate a 'Recent' menu if present)
-      setupPlaceholderMenus();
-
-      // Setup to allow user to change focus to a window from the 'Windows' menu
-      if( windowMenu )
+      else
       {
-         QObject::connect( windowMenu, SIGNAL( triggered( QAction* ) ), this, SLOT( onWindowMenuSelection( QAction* ) ) );
+         applyGuiCustomisation( customisationName );
       }
    }
 
@@ -2121,38 +2671,212 @@ QEForm* MainWindow::createGui( QString fileName, QString title, QString customis
          gui->setQEGuiTitle( title );
       }
 
-      // Create an action for the 'Window' menus
-      QAction* windowMenuAction = new QAction( gui->getQEGuiTitle(), this );
-      QVariant vgui = QVariant::fromValue( gui );    // gui is a QEForm (QWidget)
-      windowMenuAction->setData( vgui );
+      // Add this gui to the list of guis in this main window
+      addGuiToGuiList( gui, customisationName, isDock );
 
-      // Add this gui to the application wide list of guis and ensure the
-      // dock will be removed from that list if it is destroyed.
-      guiList.append( guiListItem( gui, this, windowMenuAction, customisationName, isDock ) );
-      QObject::connect( gui, SIGNAL( destroyed( QObject* )),
-                       this, SLOT( guiDestroyed( QObject* )) );
+      app->addGui( gui, customisationName );
+   }
+
+   // Return the created gui if any
+   return gui;
+}
+
+// Apply the window customisation required by a gui presented in the centre of the main window (not in a dock)
+void MainWindow::applyGuiCustomisation( QString customisationName )
+{
+   // Use the default customisations if no customisation is specified
+   if( customisationName.isEmpty() )
+   {
+      setDefaultCustomisation();
+   }
+
+   // Load any required window customisation
+   app->getMainWindowCustomisations()->applyCustomisation( this, customisationName, &customisationInfo, dockedComponents );
+
+   // Use whatever placeholder menus are available (for example, populate a 'Recent' menu if present)
+   setupPlaceholderMenus();
+
+   // Setup to allow user to change focus to a window from the 'Windows' menu
+   if( windowMenu )
+   {
+      QObject::connect( windowMenu, SIGNAL( triggered( QAction* ) ), this, SLOT( onWindowMenuSelection( QAction* ) ) );
+   }
+}
+
+// Reuse a gui offered by a configuration restore rather than create it (see QEGui::restoreConfiguration()).
+// The gui is taken as is from the main window it was released from, and given the identity, title and
+// customisation it is being restored with. Returns NULL if no gui with the same .ui file and macro
+// substitutions was offered.
+QEForm* MainWindow::reuseGui( QString fileName, QString macroSubstitutions, QString title,
+                              QString customisationName, QString restoreId, bool isDock )
+{
+   formReusePool* pool = app->getFormReusePool();
+   if( pool->isEmpty() )
+   {
+      return NULL;
+   }
 
-      // If not a dock, for each main window, add a new action to the window menu
-      if( !isDock )
+   MainWindow* from = NULL;
+   QEForm* gui = pool->take( app->getFormIndex()->formKey( fileName, macroSubstitutions ), &from );
+   if( !gui )
+   {
+      return NULL;
+   }
+
+   // Send requests from the gui's widgets to this main window
+   if( from && from != this )
+   {
+      redirectGuiRequests( gui, from );
+   }
+
+   // The restored state of the gui's widgets is found by the gui's identity
+   if( !restoreId.isNull() )
+   {
+      gui->setUniqueIdentifier( restoreId );
+   }
+
+   // Perform tasks required by a main window, but not a dock
+   if( !isDock )
+   {
+      applyGuiCustomisation( customisationName );
+   }
+
+   // If a title was supplied, use this to override the title the gui had
+   if( !title.isEmpty() )
+   {
+      gui->setQEGuiTitle( title );
+   }
+
+   // Add this gui to the list of guis in this main window
+   addGuiToGuiList( gui, customisationName, isDock );
+
+   return gui;
+}
+
+// Keep a gui being closed for reopening, if closed guis are being kept (see closedFormCache.h).
+// The gui is released from this main window as is, and suspended.
+// Returns false if closed guis are not being kept (the caller should close the gui as usual).
+bool MainWindow::cacheClosedGui( QEForm* gui )
+{
+   closedFormCache* cache = app->getClosedFormCache();
+   if( !cache->isEnabled() )
+   {
+      return false;
+   }
+
+   // Note the objects of the gui sending requests to this main window, and stop them while the gui is kept.
+   // Only these are connected again when the gui is reopened.
+   QList<QPointer<QObject> > senders;
+   QList<QObject*> objects = gui->findChildren<QObject*>();
+   objects.prepend( gui );
+   for( int i = 0; i < objects.count(); i++ )
+   {
+      QObject* object = objects[i];
+      if( object->metaObject()->indexOfSignal( "requestAction(QEActionRequests)" ) >= 0 &&
+          QObject::disconnect( object, SIGNAL( requestAction( const QEActionRequests& ) ),
+                               this, SLOT( requestAction( const QEActionRequests& ) ) ) )
       {
-         int i = 0;
-         MainWindow* mw;
-         while( (mw = app->getMainWindow( i )) )
-         {
-            mw->addWindowMenuAction( windowMenuAction );
+         senders.append( object );
+      }
+   }
 
-            // Next main window
-            i++;
-         }
+   const QString key = app->getFormIndex()->formKey( gui->getFullFileName(), gui->getMacroSubstitutions() );
+   QWidget* rGui = releaseGui( gui );
+   app->getFormSuspender()->setFormParked( gui, true );
+   cache->add( key, gui, rGui, senders );
+   return true;
+}
+
+// Reopen a recently closed gui kept for reopening (see closedFormCache.h) rather than create it.
+// The file name is resolved, and the macro substitutions taken, as if creating the gui.
+// Returns NULL if no gui with the same .ui file and macro substitutions is kept.
+QEForm* MainWindow::reopenGui( QString fileName, QString restoreId, const QEFormMapper::FormHandles& formHandle )
+{
+   closedFormCache* cache = app->getClosedFormCache();
+   if( !cache->isEnabled() )
+   {
+      return NULL;
+   }
+
+   ContainerProfile publishedProfile;
+   ContainerProfile* searchProfile = publishedProfile.isProfileDefined() ? &publishedProfile : &profile;
+   QString resolvedName = app->getFormCache()->resolve( fileName, searchProfile );
+   if( resolvedName.isEmpty() )
+   {
+      return NULL;
+   }
+
+   QList<QPointer<QObject> > senders;
+   QEForm* gui = cache->take( app->getFormIndex()->formKey( resolvedName, searchProfile->getMacroSubstitutions() ), &senders );
+   if( !gui )
+   {
+      return NULL;
+   }
+
+   // Inform user
+   newMessage( QString( "Reopening %1" ).arg( fileName ), message_types ( MESSAGE_TYPE_INFO ) );
+
+   // Send requests from the gui's widgets to this main window.
+   // Only the objects that were sending requests to the main window the gui was closed in are connected.
+   for( int i = 0; i < senders.count(); i++ )
+   {
+      if( senders[i] )
+      {
+         QObject::connect( senders[i], SIGNAL( requestAction( const QEActionRequests& ) ),
+                           this, SLOT( requestAction( const QEActionRequests& ) ) );
       }
+   }
 
-      app->addGui( gui, customisationName );
+   if( !restoreId.isNull() )
+   {
+      gui->setUniqueIdentifier( restoreId );
    }
+   gui->setFormHandle( formHandle );
+
+   // Re-activate the gui's widgets. Reconnecting presents the latest values straight away.
+   app->getFormSuspender()->setFormParked( gui, false );
 
-   // Return the created gui if any
    return gui;
 }
 
+// Offer all guis in this main window for reuse by a configuration restore (see QEGui::restoreConfiguration()).
+// Each gui is released from this main window as is, and offered under the .ui file and macro substitutions
+// it would be saved with in a configuration.
+void MainWindow::releaseGuisForReuse()
+{
+   const QString macroSubstitutions = profile.getMacroSubstitutions();
+   while( !guiList.isEmpty() )
+   {
+      QEForm* gui = guiList.last().getForm();
+      const QString key = app->getFormIndex()->formKey( gui->getFullFileName(), macroSubstitutions );
+      QWidget* rGui = releaseGui( gui );
+      app->getFormReusePool()->add( key, gui, rGui, this );
+   }
+}
+
+// Add a gui to the list of guis in this main window (and so to the 'Windows' menus of all main windows)
+void MainWindow::addGuiToGuiList( QEForm* gui, QString customisationName, bool isDock )
+{
+   // Create an action for the 'Window' menus
+   QAction* windowMenuAction = new QAction( gui->getQEGuiTitle(), this );
+   QVariant vgui = QVariant::fromValue( gui );    // gui is a QEForm (QWidget)
+   windowMenuAction->setData( vgui );
+
+   // Add this gui to the application wide list of guis and ensure the
+   // dock will be removed from that list if it is destroyed.
+   guiList.append( guiListItem( gui, this, windowMenuAction, customisationName, isDock ) );
+   app->getFormIndex()->addForm( gui, this );
+   app->markConfigurationChanged();
+   QObject::connect( gui, SIGNAL( destroyed( QObject* )),
+                    this, SLOT( guiDestroyed( QObject* )) );
+
+   // If not a dock, the 'Windows' menus of all main windows will need the new action
+   if( !isDock )
+   {
+      app->markGuiListChanged();
+   }
+}
+
 // A gui (in a dock) has been destroyed.
 // Ensure we won't reference it in the GUI list
 void  MainWindow::guiDestroyed( QObject* obj)
@@ -2244,8 +2968,8 @@ QEForm* MainWindow::getCurrentGui()
 // Methods to manage the 'Windows' and 'Recent...' menus
 //=================================================================================
 
-// Build new 'Recent...' menu
-// Used when creating a new main window
+// Build the 'Recent...' menu from the application's recent files.
+// Note, the recent file actions are owned by the application and shared by all 'Recent...' menus.
 void MainWindow::buildRecentMenu()
 {
    if( !recentMenu )
@@ -2253,18 +2977,19 @@ void MainWindow::buildRecentMenu()
       return;
    }
 
-   //    recentMenu->clear();
+   recentMenu->clear();
 
-   QList<recentFile*> files = app->getRecentFiles();
+   const QList<recentFile*>& files = app->getRecentFiles();
    for( int i = 0; i < files.count(); i++ )
    {
-      recentFile* rf = files.at( i );
-      recentMenu->addAction( rf );
+      recentMenu->addAction( files.at( i ) );
    }
+
+   recentMenuGeneration = app->getRecentFilesGeneration();
 }
 
-// Build new 'Windows' menu
-// Used when creating a new main window and there are already other main windows present with GUIs
+// Build the 'Windows' menu from all current guis (except docked ones) in all main windows.
+// Note, the gui actions are owned by the main window holding the gui and shared by all 'Windows' menus.
 void MainWindow::buildWindowsMenu()
 {
    if( !windowMenu )
@@ -2272,7 +2997,8 @@ void MainWindow::buildWindowsMenu()
       return;
    }
 
-   // Add all current guis (except docked ones) to the 'windows' menu
+   windowMenu->clear();
+
    MainWindow* mw;
    int i = 0;
 
@@ -2280,42 +3006,35 @@ void MainWindow::buildWindowsMenu()
    {
       for( int j = 0; j < mw->guiList.count(); j++ )
       {
-         if( !mw->guiList[j].getIsDock() )
+         if( !mw->guiList[j].getIsDock() && mw->guiList[j].getAction() )
          {
-            addWindowMenuAction( mw->guiList[j].getAction() );
+            windowMenu->addAction( mw->guiList[j].getAction() );
          }
       }
 
       // Next main window
       i++;
    }
+
+   windowMenuGeneration = app->getGuiListGeneration();
 }
 
-// Add a gui to a 'Recent...' menu
-void MainWindow::addRecentMenuAction( QAction* action )
+// The 'Windows' menu is about to be shown. Rebuild it if any gui has been added or removed since it was built.
+void MainWindow::windowMenuAboutToShow()
 {
-   if( !recentMenu )
-   {
-      return;
-   }
-
-   QAction* beforeAction = 0;
-   if( recentMenu->actions().count() )
+   if( windowMenuGeneration != app->getGuiListGeneration() )
    {
-      beforeAction = recentMenu->actions().at(0);
+      buildWindowsMenu();
    }
-   recentMenu->insertAction( beforeAction, action );
 }
 
-// Add a gui to a 'Window' menu
-void MainWindow::addWindowMenuAction( QAction* action )
+// The 'Recent...' menu is about to be shown. Rebuild it if the recent files have changed since it was built.
+void MainWindow::recentMenuAboutToShow()
 {
-   if( !windowMenu )
+   if( recentMenuGeneration != app->getRecentFilesGeneration() )
    {
-      return;
+      buildRecentMenu();
    }
-
-   windowMenu->addAction( action );
 }
 
 //=================================================================================
@@ -2335,7 +3054,7 @@ void MainWindow::on_actionSave_Configuration_triggered()
    resetInitialDir ();
 
    // Get the user selection
-   saveDialog sd( pm->getConfigNames( params->configurationFile, QE_CONFIG_NAME ) );
+   saveDialog sd( configStore::getConfigNames( pm, params->configurationFile, QE_CONFIG_NAME ) );
 
    QEScaling::applyToWidget( &sd ); // Ensure scaling is consistent with the rest of the application's forms.
 
@@ -2365,8 +3084,9 @@ void MainWindow::on_actionSave_Configuration_triggered()
    app->saveConfiguration( pm, params->configurationFile, QE_CONFIG_NAME, configName, true );
 }
 
-// The user has requested a restore of a saved configuration
-void MainWindow::on_actionRestore_Configuration_triggered()
+// Ask the user to select a saved configuration (for restoring, or switching workspace).
+// Returns an empty name if there are none, or the user cancelled.
+QString MainWindow::selectConfiguration( QString caption )
 {
    PersistanceManager* pm = profile.getPersistanceManager();
    startupParams* params = app->getParams();
@@ -2377,19 +3097,19 @@ void MainWindow::on_actionRestore_Configuration_triggered()
 
    // Get the list of restoration options
    bool hasDefault;
-   QStringList configNames = pm->getConfigNames( params->configurationFile, QE_CONFIG_NAME, hasDefault );
+   QStringList configNames = configStore::getConfigNames( pm, params->configurationFile, QE_CONFIG_NAME, hasDefault );
    if( configNames.count() == 0 && !hasDefault )
    {
-      QMessageBox::warning( this, "Configuration Restore",
+      QMessageBox::warning( this, caption,
                            "There are no configurations available to restore." );
-      return;
+      return QString();
    }
 
    // Get the user selection
    restoreDialog rd( configNames, hasDefault );
    if ( rd.exec( this ) == QDialog::Rejected )
    {
-      return;
+      return QString();
    }
 
    QString configName;
@@ -2405,18 +3125,161 @@ void MainWindow::on_actionRestore_Configuration_triggered()
    {
       // The OK button should only be enabled if there is a configuration selected
       sendMessage( "No configuration selected",
-                  "QEGui application. MainWindow::on_actionRestore_Configuration_triggered()" );
+                  "QEGui application. MainWindow::selectConfiguration()" );
+   }
+   return configName;
+}
+
+// The user has requested a restore of a saved configuration
+void MainWindow::on_actionRestore_Configuration_triggered()
+{
+   QString configName = selectConfiguration( "Configuration Restore" );
+   if( configName.isEmpty() )
+   {
       return;
    }
 
-   // Close all current windows
-   closeAll();
+   // Close all current windows and restore the configuration.
+   // Any guis already open that are in the configuration are reused rather than re-created.
+   PersistanceManager* persistanceManager = profile.getPersistanceManager();
+   app->restoreConfiguration( persistanceManager, app->getParams()->configurationFile, QE_CONFIG_NAME, configName );
+}
+
+// The user has requested a switch to another workspace (a saved configuration kept alive while not in use).
+// Refer to workspaceManager.h for details.
+void MainWindow::on_actionSwitch_Workspace_triggered()
+{
+   QString configName = selectConfiguration( "Switch Workspace" );
+   if( configName.isEmpty() )
+   {
+      return;
+   }
 
-   // Ask the persistance manager to restore a configuration.
-   // The persistance manager will signal all interested objects (including this application) that
-   // they should collect and apply restore data.
+   // Park the workspace in use (this main window may be one of its windows), then show or restore the workspace selected
    PersistanceManager* persistanceManager = profile.getPersistanceManager();
-   persistanceManager->restore( params->configurationFile, QE_CONFIG_NAME, configName );
+   app->getWorkspaceManager()->switchTo( persistanceManager, app->getParams()->configurationFile, configName );
+}
+
+// Hide this main window and suspend its guis. It is being kept in a workspace not in use (see workspaceManager.h).
+// The main window is no longer one of the application's main windows until unparked.
+void MainWindow::park()
+{
+   app->removeMainWindow( this );
+
+   formSuspender* suspender = app->getFormSuspender();
+   for( int i = 0; i < guiList.count(); i++ )
+   {
+      suspender->setFormParked( guiList[i].getForm(), true );
+   }
+
+   hide();
+}
+
+// Show this main window and re-activate its guis. Its workspace is being used again.
+void MainWindow::unpark()
+{
+   app->addMainWindow( this );
+
+   formSuspender* suspender = app->getFormSuspender();
+   for( int i = 0; i < guiList.count(); i++ )
+   {
+      app->getFormIndex()->addForm( guiList[i].getForm(), this );
+      suspender->setFormParked( guiList[i].getForm(), false );
+   }
+
+   show();
+
+   // Let the application know which guis can now be seen
+   updateFormVisibility();
+}
+
+// Close this main window. It was parked in a workspace that has been discarded.
+void MainWindow::discard()
+{
+   beingDeleted = true;
+   close();
+}
+
+// The main window has moved, been resized, or changed state. Note the change for auto-save.
+void MainWindow::moveEvent( QMoveEvent* event )
+{
+   app->markConfigurationChanged();
+   QMainWindow::moveEvent( event );
+}
+
+void MainWindow::resizeEvent( QResizeEvent* event )
+{
+   app->markConfigurationChanged();
+   QMainWindow::resizeEvent( event );
+}
+
+void MainWindow::changeEvent( QEvent* event )
+{
+   QMainWindow::changeEvent( event );
+   if( event->type() == QEvent::WindowStateChange )
+   {
+      app->markConfigurationChanged();
+
+      // Guis in a minimised window can't be seen
+      updateFormVisibility();
+   }
+}
+
+// The load on the GUI thread has changed (adaptive refresh governing).
+// Hidden guis are suspended while loaded, so let the application know which guis in this window can be seen.
+void MainWindow::loadLevelChanged( int )
+{
+   updateFormVisibility();
+}
+
+// Let the application know which guis in this window can be seen, so those that can't may be suspended.
+// Guis can't be seen if they are in a tab other than the current tab, in a hidden dock, or if the window is minimised.
+void MainWindow::updateFormVisibility()
+{
+   formSuspender* suspender = app->getFormSuspender();
+   if( !suspender->isEnabled() )
+   {
+      return;
+   }
+
+   const bool minimised = isMinimized();
+   QTabWidget* tabs = usingTabs ? getCentralTabs() : NULL;
+   QWidget* currentTab = tabs ? tabs->currentWidget() : NULL;
+
+   for( int i = 0; i < guiList.count(); i++ )
+   {
+      QEForm* form = guiList[i].getForm();
+      bool visible = !minimised;
+      if( visible )
+      {
+         if( guiList[i].getIsDock() )
+         {
+            QDockWidget* dock = getGuiDock( form );
+            visible = dock && dock->isVisible();
+         }
+         else if( tabs )
+         {
+            visible = currentTab && ( currentTab == form || currentTab->isAncestorOf( form ) );
+         }
+      }
+      suspender->setFormVisible( form, visible );
+   }
+}
+
+// A dock has moved or been resized. Note the change for auto-save.
+bool MainWindow::eventFilter( QObject* watched, QEvent* event )
+{
+   if( event->type() == QEvent::Move || event->type() == QEvent::Resize )
+   {
+      app->markConfigurationChanged();
+   }
+   return QMainWindow::eventFilter( watched, event );
+}
+
+// The layout (dock location or visibility, scroll position, etc) has changed. Note the change for auto-save.
+void MainWindow::layoutChanged()
+{
+   app->markConfigurationChanged();
 }
 
 // Manage the form scaling configurations
@@ -2489,7 +3352,7 @@ void MainWindow::on_actionManage_Configurations_triggered()
 
    // Get the list of configuration options
    bool hasDefault;
-   QStringList configNames = pm->getConfigNames( params->configurationFile, QE_CONFIG_NAME, hasDefault );
+   QStringList configNames = configStore::getConfigNames( pm, params->configurationFile, QE_CONFIG_NAME, hasDefault );
    if( configNames.count() == 0 && !hasDefault )
    {
       QMessageBox::warning( this, "Configuration Management",
@@ -2509,8 +3372,16 @@ void MainWindow::saveRestore( SaveRestoreSignal::saveRestoreOptions option )
 {
    PersistanceManager* pm = profile.getPersistanceManager();
 
+   // Main windows not in the application's list (pooled shells not yet in use, or windows
+   // being deleted) have nothing to save or restore.
+   const int mainWindowPosition = app->getMainWindowPosition( this );
+   if( mainWindowPosition < 0 )
+   {
+      return;
+   }
+
    // Build a unique name based on the order of the main window in the main window list
-   QString mainWindowName = QString( "QEGuiMainWindow_%1" ).arg( app->getMainWindowPosition( this ) );
+   QString mainWindowName = QString( "QEGuiMainWindow_%1" ).arg( mainWindowPosition );
 
    switch( option )
    {
@@ -2538,10 +3409,19 @@ void MainWindow::saveRestore( SaveRestoreSignal::saveRestoreOptions option )
             // more than one gui in a tab widget. Redundant but harmless if only one gui is present.
             QEForm* currentGui = getCurrentGui();
 
-            // Save details for each GUI
-            for( int i = 0; i < guiList.count(); i++ )
+            // Save details for each GUI in the order presented (tab order, then docks), including
+            // placeholders for GUIs not yet created (lazy restore), so it is restored the same way again.
+            QList<QWidget*> guis = getGuisInOrder();
+            for( int g = 0; g < guis.count(); g++ )
             {
-               QEForm* gui = guiList[i].getForm();
+               guiPlaceholder* placeholder = qobject_cast<guiPlaceholder*>( guis[g] );
+               if( placeholder )
+               {
+                  savePlaceholder( mw, placeholder );
+                  continue;
+               }
+
+               QEForm* gui = static_cast<QEForm*>( guis[g] );
                // Gui name and ID
                PMElement form =  mw.addElement( "Gui" );
                form.addAttribute( "Name", gui->getFullFileName() );
@@ -2648,8 +3528,8 @@ void MainWindow::saveRestore( SaveRestoreSignal::saveRestoreOptions option )
                            }
                         }
 
-                        // If more than one, GUI is in a TAB
-                        if( count > 1 )
+                        // If more than one (including any placeholder tabs), GUI is in a TAB
+                        if( count > 1 || ( usingTabs && !placeholders.isEmpty() ) )
                         {
                            form.addValue( "Presentation", QString( "Tab" ));
                            break;
@@ -2706,9 +3586,8 @@ void MainWindow::saveRestore( SaveRestoreSignal::saveRestoreOptions option )
                 geometry.getAttribute( "Width", w ) &&
                 geometry.getAttribute( "Height", h ) )
             {
-               // Set the geometry in a timer event. This will occur after events due to creation have finished arriving.
-               setGeomRect = QRect( x, y, w, h );
-               QTimer::singleShot(10, this, SLOT(setGeom()));
+               // Set the geometry once the window manager has decorated the window (along with all other windows being restored)
+               app->getGeometryRestore()->add( this, QRect( x, y, w, h ) );
             }
 
             // Get the state of the window (iconised, maximised, etc
@@ -2730,7 +3609,9 @@ void MainWindow::saveRestore( SaveRestoreSignal::saveRestoreOptions option )
                setDefaultCustomisation();
             }
 
-            // Create all the guis required for this main window
+            // Create all the guis required for this main window.
+            // (Any placeholders created for a lazy restore are left in place until all guis are restored)
+            deferPlaceholders = true;
             for(int i = 0; i < guiElements.count(); i++ )
             {
                PMElement guiElement = guiElements.getElement( i );
@@ -2782,9 +3663,6 @@ void MainWindow::saveRestore( SaveRestoreSignal::saveRestoreOptions option )
                      QString title;
                      guiElement.getValue( "Title", title );
 
-                     bool isDock = !presentation.compare( "Dock" );
-                     QEForm* gui = createGui( name, title, customisationName, QEFormMapper::nullHandle(), restoreId, isDock );
-
                      // If no presentation, assume the first gui is a central gui and any more are tabs.
                      // (in which case the first was also a tab and will be converted to a tab when the second tab is added)
                      if( presentation.isEmpty() )
@@ -2798,6 +3676,96 @@ void MainWindow::saveRestore( SaveRestoreSignal::saveRestoreOptions option )
                            presentation = QString( "Tab" );
                         }
                      }
+                     bool isDock = !presentation.compare( "Dock" );
+
+                     // Note if this gui is the current gui (not relevant for docks)
+                     bool currentGuiFlag = false;
+                     guiElement.getAttribute( "CurrentGui", currentGuiFlag ) ;
+
+                     // Note any scroll position (not relevant for docks)
+                     PMElement scroll = guiElement.getElement( "Scroll" );
+                     int scrollX, scrollY;
+                     bool hasScroll = scroll.getAttribute( "X", scrollX ) &&
+                                      scroll.getAttribute( "Y", scrollY );
+
+                     // Note any docking details
+                     PMElement docking = guiElement.getElement( "Docking" );
+
+                     int allowedAreas = Qt::AllDockWidgetAreas;
+                     int features = QDockWidget::DockWidgetFeatureMask;
+                     bool floating = false;
+
+                     int x = 0;
+                     int y = 0;
+                     int width = 100;
+                     int height = 100;
+                     int area = Qt::BottomDockWidgetArea;
+                     bool hidden = false;
+                     bool tabbed = false;
+                     QE::CreationOptions createOption = QE::DockFloating;
+                     if( isDock )
+                     {
+                        docking.getAttribute( QString( "AllowedAreas" ), allowedAreas );
+                        docking.getAttribute( QString( "Area" ), area );
+                        docking.getAttribute( "Features", features );
+                        docking.getAttribute( "Floating", floating );
+                        docking.getAttribute( "X", x );
+                        docking.getAttribute( "Y", y );
+                        docking.getAttribute( "Width", width );
+                        docking.getAttribute( "Height", height );
+                        docking.getAttribute( "Hidden", hidden );
+                        docking.getAttribute( "Tabbed", tabbed );
+
+                        if( !floating )
+                        {
+                           createOption = dockLocationToCreationOption( (Qt::DockWidgetArea)area, tabbed );
+                        }
+                     }
+
+                     // If the gui was already open when the restore was requested, reuse it
+                     QEForm* gui = reuseGui( name, macroSubstitutions, title, customisationName, restoreId, isDock );
+                     const bool reused = ( gui != NULL );
+
+                     // If restoring lazily, restore background tabs and hidden docks as placeholders.
+                     // The gui will be created when the tab is first selected or the dock is first shown.
+                     bool isTab = !presentation.compare( "Tab" );
+                     if( !reused && app->getParams()->lazyRestore && ( ( isTab && !currentGuiFlag ) || ( isDock && hidden ) ) )
+                     {
+                        guiPlaceholder* placeholder = new guiPlaceholder( name, title, customisationName, restoreId,
+                                                                          pathList, macroSubstitutions );
+                        placeholder->hasScroll = hasScroll;
+                        if( hasScroll )
+                        {
+                           placeholder->scroll = QPoint( scrollX, scrollY );
+                        }
+                        placeholders.append( placeholder );
+                        QObject::connect( placeholder, SIGNAL( destroyed( QObject* ) ),
+                                          this, SLOT( placeholderDestroyed( QObject* ) ) );
+
+                        if( isTab )
+                        {
+                           // If not using tabs, start tabs and migrate any single gui to the first tab
+                           if( !usingTabs )
+                              setTabMode();
+
+                           QTabWidget* tabs = getCentralTabs();
+                           if( tabs )
+                           {
+                              tabs->addTab( placeholder, title );
+                           }
+                        }
+                        else
+                        {
+                           QDockWidget* dock = loadWidgetIntoNewDock( placeholder, title, hidden, createOption, (Qt::DockWidgetArea)allowedAreas, (QDockWidget::DockWidgetFeature)features, QRect( x, y, width, height ) );
+                           dockedComponents.insert( title, dock );
+                        }
+                        continue;
+                     }
+
+                     if( !reused )
+                     {
+                        gui = createGui( name, title, customisationName, QEFormMapper::nullHandle(), restoreId, isDock );
+                     }
 
                      // If the gui is the central widget, create it as such
                      if( presentation.compare( "Central" ) == 0 )
@@ -2807,7 +3775,7 @@ void MainWindow::saveRestore( SaveRestoreSignal::saveRestoreOptions option )
                      }
 
                      // If the gui is a tab, create it as such
-                     else if( presentation.compare( "Tab" ) == 0 )
+                     else if( isTab )
                      {
                         if( gui )
                         {
@@ -2821,44 +3789,11 @@ void MainWindow::saveRestore( SaveRestoreSignal::saveRestoreOptions option )
                      }
 
                      // If the gui is a dock, create it as such
-                     else if( presentation.compare( "Dock" ) == 0 )
+                     else if( isDock )
                      {
                         if( gui )
                         {
-                           PMElement docking = guiElement.getElement( "Docking" );
-
-                           int allowedAreas = Qt::AllDockWidgetAreas;
-                           int features = QDockWidget::DockWidgetFeatureMask;
-                           bool floating = false;
-
-                           int x = 0;
-                           int y = 0;
-                           int width = 100;
-                           int height = 100;
-                           int area = Qt::BottomDockWidgetArea;
-                           bool hidden = false;
-                           bool tabbed = false;
-                           docking.getAttribute( QString( "AllowedAreas" ), allowedAreas );
-                           docking.getAttribute( QString( "Area" ), area );
-                           docking.getAttribute( "Features", features );
-                           docking.getAttribute( "Floating", floating );
-                           docking.getAttribute( "X", x );
-                           docking.getAttribute( "Y", y );
-                           docking.getAttribute( "Width", width );
-                           docking.getAttribute( "Height", height );
-                           docking.getAttribute( "Hidden", hidden );
-                           docking.getAttribute( "Tabbed", tabbed );
-
                            // Create gui as a new dock
-                           QE::CreationOptions createOption;
-                           if( floating )
-                           {
-                              createOption = QE::DockFloating;
-                           }
-                           else
-                           {
-                              createOption = dockLocationToCreationOption( (Qt::DockWidgetArea)area, tabbed );
-                           }
                            QDockWidget* dock = loadGuiIntoNewDock( gui, hidden, createOption, (Qt::DockWidgetArea)allowedAreas, (QDockWidget::DockWidgetFeature)features, QRect( x, y, width, height ) );
 
                            // Record that this dock has been added
@@ -2867,34 +3802,72 @@ void MainWindow::saveRestore( SaveRestoreSignal::saveRestoreOptions option )
                               dockedComponents.insert( gui->getQEGuiTitle(), dock );
                            }
                         }
+                     }
 
-                        // If not a dock...
-                        if( presentation.compare( "Dock" ) )
+                     // A reused gui was hidden when released from its previous main window.
+                     // (Tabs are shown and hidden by the tab widget as they are selected)
+                     if( reused && !isTab )
+                     {
+                        QScrollArea* sa = guiScrollArea( gui );
+                        if( sa )
                         {
-                           // Note if this gui is the current gui
-                           bool currentGuiFlag = false;
-                           guiElement.getAttribute( "CurrentGui", currentGuiFlag ) ;
-                           if( currentGuiFlag )
-                           {
-                              currentGui = gui;
-                           }
+                           sa->show();
+                        }
+                        else
+                        {
+                           gui->show();
+                        }
+                     }
 
-                           // Note any scroll position
-                           // This scroll position will be applied by scrollTo(), which is a timer event
-                           // that will be run after the restored geometry has been applied.
-                           // (Note, the gui has just been placed at the end of the gui list)
-                           PMElement scroll = guiElement.getElement( "Scroll" );
-                           int x, y;
-                           if( scroll.getAttribute( "X", x ) &&
-                               scroll.getAttribute( "Y", y ) )
-                           {
-                              guiList.last().setScroll( QPoint( x, y ) );
-                           }
+                     // If not a dock...
+                     if( gui && !isDock )
+                     {
+                        // Note if this gui is the current gui
+                        if( currentGuiFlag )
+                        {
+                           currentGui = gui;
+                        }
+
+                        // Note any scroll position
+                        // This scroll position will be applied by applyRestoredScroll(), which will be
+                        // called after the restored geometry has been applied.
+                        // (Note, the gui has just been placed at the end of the gui list)
+                        if( hasScroll )
+                        {
+                           guiList.last().setScroll( QPoint( scrollX, scrollY ) );
                         }
                      }
                   }
                }
             }
+            deferPlaceholders = false;
+
+            // If using tabs, select the tab holding the current gui.
+            // If the tab selected is a placeholder (lazy restore), the gui will be created now.
+            QTabWidget* tabs = getCentralTabs();
+            if( tabs )
+            {
+               int currentIndex = tabs->currentIndex();
+               for( int j = 0; currentGui && j < tabs->count(); j++ )
+               {
+                  if( extractGui( tabs->widget( j ) ) == currentGui )
+                  {
+                     currentIndex = j;
+                     break;
+                  }
+               }
+               if( currentIndex >= 0 && currentIndex != tabs->currentIndex() )
+               {
+                  tabs->setCurrentIndex( currentIndex );
+               }
+               else if( currentIndex >= 0 && qobject_cast<guiPlaceholder*>( tabs->widget( currentIndex ) ) )
+               {
+                  tabCurrentChanged( currentIndex );
+               }
+            }
+
+            // Let the application know which guis can now be seen (reused guis may have been hidden where they were)
+            updateFormVisibility();
 
             // Regardless of any titles set by GUIs that have been opened, apply the title saved with the main window
             // This is often redundant as the title will be correctly set already fromn the current main GUI, but
@@ -2903,12 +3876,6 @@ void MainWindow::saveRestore( SaveRestoreSignal::saveRestoreOptions option )
             {
                setTitle( mwTitle );
             }
-
-            // If this new GUI is the current one, make it so
-            if( currentGui )
-            {
-               raiseGui( currentGui );
-            }
          }
          break;
 
@@ -2925,8 +3892,11 @@ void MainWindow::deleteConfigs( manageConfigDialog* mcd, const QStringList names
    PersistanceManager* pm = profile.getPersistanceManager();
    startupParams* params = app->getParams();
 
-   pm->deleteConfigs( params->configurationFile, QE_CONFIG_NAME, names, true );
-   mcd->setCurrentNames( pm->getConfigNames( params->configurationFile, QE_CONFIG_NAME ) );
+   // Don't write the configuration file while an auto-save is writing it in the background
+   app->waitForAutoSaveWrite();
+
+   configStore::deleteConfigs( pm, params->configurationFile, QE_CONFIG_NAME, names, true );
+   mcd->setCurrentNames( configStore::getConfigNames( pm, params->configurationFile, QE_CONFIG_NAME ) );
 }
 
 //=================================================================================
@@ -2969,102 +3939,11 @@ QScrollArea* MainWindow::guiScrollArea( QEForm* gui )
    return NULL;
 }
 
-// Set a gui geometry.
-// This is called as part of restoring a main window.
-// When restoring a window under X11, setting its geometry and scroll position is complicated
-// by the X11 window manager.
-// At some time after window creation the window manager will add the window decorations
-// (title bar, borders, etc)
-// Since the position was saved with the window decorations the position needs to be restored
-// after the window decorations have been added or the window will be moved to the wrong position
-// when decorations are added.
-// Since the X11 window manager operates asynchronously to the application the addition of the
-// window decorations is infered when the origin of the window geometry frame geometry changes.
-// This is reasonably robust, but would fail if there is no X11 window manager running, or
-// some weird window manager is running which adds no decorations to the top or left of the
-// window leaving both window geometry and frame geometry at the same position.
-// To ensure a failure des not result in waiting forever, the wait is limited to a maximum.
-void MainWindow::setGeom()
-{
-   // Loop until the X11 window manager has added window decorations.
-   // When decorations have been added, position of window geometry and frame geometry will differ.
-   // (Set the size regardless of decoration after maximum of 10 seconds)
-   if(( geometry().x() == frameGeometry().x() )&&
-       ( geometry().y() == frameGeometry().y() ) &&
-       ( waitForX11WindowManagerCount < 1000 ) ) /* 1000 = 1000 x 10ms = 10 seconds */
-   {
-      QTimer::singleShot(10, this, SLOT( setGeom() ));
-      waitForX11WindowManagerCount++;
-      return;
-   }
-   waitForX11WindowManagerCount = 0;
-
-   // Set the geometry as noted during the restore
-
-   const QRect desktopGeometry = QEUtilities::desktopGeometry();
-   const int leftLimit   = desktopGeometry.left()  + 100;
-   const int rightLimit  = desktopGeometry.right() - 100;
-   const int limitTop    = desktopGeometry.top()    + 50;
-   const int limitBottom = desktopGeometry.bottom() - 50;
-
-   // Ensure restored window geometry is at least partially on screen.
-   //
-   if ( setGeomRect.right () <= leftLimit )
-   {
-      setGeomRect.moveRight( leftLimit );
-   }
-   else if( setGeomRect.left () >= rightLimit )
-   {
-      setGeomRect.moveLeft( rightLimit );
-   }
-
-   if ( setGeomRect.top () <= limitTop )
-   {
-      // Need top of window on screen.
-      setGeomRect.moveTop( limitTop );
-   }
-   else if( setGeomRect.top () >= limitBottom )
-   {
-      setGeomRect.moveTop( limitBottom );
-   }
-
-   setGeometry( setGeomRect );
-
-   // Initiate scrolling of guis within the main window
-   QTimer::singleShot( 10, this, SLOT(scrollTo() ));
-}
-
 // Scroll all guis in a main window.
-// This is called as part of restoring a main window.
-// When restoring a window under X11, setting its geometry and scroll position is complicated
-// by the X11 window manager.
-// The X11 window manager services a request to resize the window some time after the request
-// is made.
-// Since the X11 window manager operates asynchronously to the application the resize of the
-// window decorations is infered by the size changing to the required size.
-// This is reasonably robust, but may fail if there is no X11 window manager running, or
-// the display size has changed since the size was saved and the X11 window manager is not
-// willing to set the size to that requested.
-// To ensure a failure does not result in waiting forever, the wait is limited to a maximum.
-void MainWindow::scrollTo()
-{
-   // Loop until the X11 window manager has set the size. (abandon scrolling after maximum of 10 seconds)
-   if( setGeomRect.width() != width() ||
-       setGeomRect.height() != height() )
-   {
-      if( waitForX11WindowManagerCount < 1000 )/* 1000 = 1000 x 10ms = 10 seconds */
-      {
-         QTimer::singleShot(10, this, SLOT( scrollTo() ));
-         waitForX11WindowManagerCount++;
-         return;
-      }
-      else
-      {
-         waitForX11WindowManagerCount = 0;
-         return;
-      }
-   }
-
+// This is called as part of restoring a main window, once the restored geometry has been
+// applied and the window manager has set the size. Refer to geometryRestore.h for details.
+void MainWindow::applyRestoredScroll()
+{
    // The window is ready for scrolling if required.
    for( int i = 0; i < guiList.count(); i++ )
    {
@@ -3116,7 +3995,10 @@ void MainWindow::removeGuiFromGuiList( int i )
 
    // Delete the action. This will remove it from all the menus it was associated with
    guiList[i].deleteAction();
+   app->getFormIndex()->removeForm( guiList[i].getForm() );
    guiList.removeAt( i );
+   app->markGuiListChanged();
+   app->markConfigurationChanged();
 }
 
 // Get any customisation name for a GUI
@@ -3132,99 +4014,51 @@ QString MainWindow::getCustomisationName( QEForm* gui )
    return QString();
 }
 
-// Check if a GUI already exists in this main window (with matching macro substitutions)
-// and ensure is visible and has focus.
-// Return true if found
+// Ensure a GUI in this main window is visible and has focus.
+// The GUI is located using the application's index of open GUIs (see QEGui::raiseGui()).
+// Return true if the GUI is in this main window
 //
-bool MainWindow::showGui( QString guiFileName, QString macroSubstitutions )
+bool MainWindow::showGui( QEForm* form )
 {
-   // Look for a form matching the gui name and with the same substitutions
-   for( int i = 0; i < guiList.count(); i++ )
+   // Roll back up the widget hierarchy to this main window.
+   // If a parent tab widget is found, set the child as the active tab.
+   QWidget* w = form->parentWidget();
+   while( w && w != this )
    {
-      QEForm* form = guiList[i].getForm();
-      if( !form->getFullFileName().compare( guiFileName ) &&
-          !form->getMacroSubstitutions().trimmed().compare( macroSubstitutions ) )
+      QTabWidget* tw = qobject_cast<QTabWidget*>( w );
+      if( tw )
       {
-         // This code replaces the winding back up the widget hierarchy (below) looking for a tab widget and the MainWindow
-         // This can be avoided now the guiList contains the MainWindow the gui is in, but this code isn't tested yet and a
-         // quick run appeared to have problems: when opening many forms through a QEPushButton (when this is called) forms
-         // ended up overlayed over each other in the same tab
-
-         //                MainWindow* mw = guiList[i].getMainWindow();
-
-         //                // If a tab widget is found, set the gui as the active tab
-         //                QTabWidget* tw = mw->getCentralTabs();
-         //                if( tw )
-         //                {
-         //                    int j;
-         //                    j = tw->indexOf( form ) ;
-         //                    if( j < 0 )
-         //                    {
-         //                        j = tw->indexOf( form->parentWidget() ) ;
-         //                        if( j < 0 )
-         //                        {
-         //                            j = tw->indexOf( form->parentWidget()->parentWidget() ) ;
-         //                        }
-         //                    }
-         //                    if( j >= 0 )
-         //                    {
-         //                        tw->setCurrentIndex( j );
-         //                    }
-         //                }
-
-         //                // Display the main window
-         //                mw->show();
-         //                mw->raise();
-         //                mw->activateWindow();
-         //                return;
-
-
-         // GUI found. Roll back up the widget hierarchy.
-         // If a parent tab widget is found, set the child as the active tab, when the main window is found, display it.
-         QWidget* w = form->parentWidget();
-         while( w )
+         // The tab may be the gui, or a scroll area holding the gui
+         int j = tw->indexOf( form );
+         if( j < 0 && form->parentWidget() )
          {
-            // Ensure the correct tab is selected
-            if( QString::compare( w->metaObject()->className(), "QTabWidget" ) == 0 )
-            {
-               QTabWidget* tw = (QTabWidget*)w;
-               int j;
-               j = tw->indexOf( form ) ;
-               if( j < 0 )
-               {
-                  j = tw->indexOf( form->parentWidget() ) ;
-                  if( j < 0 )
-                  {
-                     j = tw->indexOf( form->parentWidget()->parentWidget() ) ;
-                  }
-               }
-               if( j >= 0 )
-               {
-                  tw->setCurrentIndex( j );
-               }
-            }
-
-            // Display the main window
-            if( QString::compare( w->metaObject()->className(), "MainWindow" ) == 0 )
+            j = tw->indexOf( form->parentWidget() );
+            if( j < 0 && form->parentWidget()->parentWidget() )
             {
-               w->show();
-               w->raise();
-               w->activateWindow();
-
-               return true;  // (MainWindow*)w;
+               j = tw->indexOf( form->parentWidget()->parentWidget() );
             }
-
-            // Move up a generation
-            w = w->parentWidget();
          }
-
-         // GUI found, but could not locate the GUI in the widget hierarchy
-         return false;
+         if( j >= 0 )
+         {
+            tw->setCurrentIndex( j );
+         }
       }
+
+      // Move up a generation
+      w = w->parentWidget();
    }
 
-   // Gui not found
-   return false;
+   // GUI found, but not in this main window
+   if( !w )
+   {
+      return false;
+   }
+
+   // Display the main window
+   show();
+   raise();
+   activateWindow();
+   return true;
 }
 
 // Ensure the main window and all its QEForms (top level forms only) have a unique identifier
@@ -3233,12 +4067,138 @@ void MainWindow::identifyWindowAndForms( int mwIndex )
    // Give the main window a unique ID for restoration purposes
    setUniqueId( mwIndex );
 
-   // Give all top level QEForms (managed by this application - not sub forms) a unique ID for restoration purposes
-   for( int i = 0; i < guiList.count(); i++ )
+   // Give all top level QEForms (managed by this application - not sub forms) a unique ID for restoration purposes.
+   // Placeholders for GUIs not yet created (lazy restore) are numbered along with them, so no two share an ID.
+   // (A placeholder keeps the ID it was restored with for creating its GUI, the new ID is only used when saving)
+   QList<QWidget*> guis = getGuisInOrder();
+   for( int i = 0; i < guis.count(); i++ )
    {
-      // Get form and main window details
       QString name = QString("QEGui_window_%1_form_%2" ).arg( getUniqueId() ).arg( i );
-      guiList[i].getForm()->setUniqueIdentifier( name );
+      guiPlaceholder* placeholder = qobject_cast<guiPlaceholder*>( guis[i] );
+      if( placeholder )
+      {
+         placeholder->saveId = name;
+      }
+      else
+      {
+         static_cast<QEForm*>( guis[i] )->setUniqueIdentifier( name );
+      }
+   }
+}
+
+// Return the GUIs in this main window in the order presented: those in the central widget (in tab order),
+// then those in docks (in the order the docks were created). Placeholders for GUIs not yet created
+// (lazy restore) are included in their place, so each item is either a QEForm or a guiPlaceholder.
+QList<QWidget*> MainWindow::getGuisInOrder()
+{
+   // All GUIs (and placeholders) managed by this main window
+   QList<QWidget*> managed;
+   for( int i = 0; i < guiList.count(); i++ )
+   {
+      managed.append( guiList[i].getForm() );
+   }
+   for( int i = 0; i < placeholders.count(); i++ )
+   {
+      managed.append( placeholders[i] );
+   }
+
+   // Note those presented in the central widget, and in docks
+   QList<QWidget*> presented;
+   QTabWidget* tabs = getCentralTabs();
+   if( tabs )
+   {
+      for( int i = 0; i < tabs->count(); i++ )
+      {
+         presented.append( tabs->widget( i ) );
+      }
+   }
+   else if( centralWidget() )
+   {
+      presented.append( centralWidget() );
+   }
+
+   QList<QDockWidget*> docks = findChildren<QDockWidget*>();
+   for( int i = 0; i < docks.count(); i++ )
+   {
+      presented.append( docks[i]->widget() );
+   }
+
+   // Build the list in presentation order
+   QList<QWidget*> guis;
+   for( int i = 0; i < presented.count(); i++ )
+   {
+      QWidget* w = presented[i];
+      QWidget* gui = ( !w || qobject_cast<guiPlaceholder*>( w ) ) ? w : extractGui( w );
+      if( gui && managed.contains( gui ) && !guis.contains( gui ) )
+      {
+         guis.append( gui );
+      }
+   }
+
+   // Anything else (not expected), so nothing is lost
+   for( int i = 0; i < managed.count(); i++ )
+   {
+      if( !guis.contains( managed[i] ) )
+      {
+         guis.append( managed[i] );
+      }
+   }
+
+   return guis;
+}
+
+// Save details of a placeholder for a GUI not yet created (lazy restore),
+// as it was restored, so it is restored the same way again.
+void MainWindow::savePlaceholder( PMElement& mw, guiPlaceholder* placeholder )
+{
+   PMElement form =  mw.addElement( "Gui" );
+   form.addAttribute( "Name", placeholder->fileName );
+   form.addAttribute( "ID", placeholder->saveId.isEmpty() ? placeholder->restoreId : placeholder->saveId );
+
+   if( !placeholder->macroSubstitutions.isEmpty() )
+   {
+      form.addValue( "MacroSubstitutions", placeholder->macroSubstitutions );
+   }
+   if( !placeholder->customisationName.isEmpty() )
+   {
+      form.addValue( "CustomisationName", placeholder->customisationName );
+   }
+   for( int j = 0; j < placeholder->pathList.count(); j++ )
+   {
+      PMElement pl = form.addElement( "PathListItem" );
+      pl.addAttribute( "Order", j );
+      pl.addValue( QString( "Path" ), placeholder->pathList.at( j ) );
+   }
+   if( placeholder->hasScroll )
+   {
+      PMElement pos =  form.addElement( "Scroll" );
+      pos.addAttribute( "X", placeholder->scroll.x() );
+      pos.addAttribute( "Y", placeholder->scroll.y() );
+   }
+   form.addValue( "Title", placeholder->title );
+
+   QDockWidget* dock = getGuiDock( placeholder );
+   if( dock )
+   {
+      form.addValue( "Presentation", QString( "Dock" ));
+      PMElement docking =  form.addElement( "Docking" );
+      docking.addAttribute( "AllowedAreas", int( dock->allowedAreas() ) );
+      docking.addAttribute( "Area", int ( dockWidgetArea( dock ) ) );
+      docking.addAttribute( "Features", int ( dock->features() ) );
+      docking.addAttribute( "Floating", dock->isFloating() );
+      docking.addAttribute( "X", dock->x() );
+      docking.addAttribute( "Y", dock->y() );
+      docking.addAttribute( "Width", dock->width() );
+      docking.addAttribute( "Height", dock->height() );
+      docking.addAttribute( "Hidden", !dock->isVisible() );
+      if( tabifiedDockWidgets( dock ).count() )
+      {
+         docking.addAttribute( "Tabbed", true );
+      }
+   }
+   else
+   {
+      form.addValue( "Presentation", QString( "Tab" ));
    }
 }
 
@@ -22,6 +22,7 @@
 #include <QEForm.h>
 #include <UserMessage.h>
 #include <ContainerProfile.h>
+#include <persistanceManager.h>
 #include <QMap>
 #include <QProcess>
 #include <QTimer>
@@ -32,6 +33,7 @@
 #include <QCloseEvent>
 #include <QDockWidget>
 #include <caQtDmInterface.h>
+#include <guiPlaceholder.h>
 
 class QEGui;
 class MainWindow;
@@ -106,6 +108,8 @@ class MainWindow : public QMainWindow, public UserMessage
 {
     Q_OBJECT
 
+    friend class benchmark;                                 // The benchmark (-B) drives main window internals directly
+
 public:
     // Constructor
     // A profile should have been defined before calling this constructor.
@@ -119,16 +123,23 @@ public:
 
     ~MainWindow();
 
+    // Open a file in a pre-constructed (hidden, pooled) main window with its own path list and macro substitutions
+    void openInShell( QString fileName, QString customisationName,
+                      const QStringList& pathList, const QString& macroSubstitutions );
+
     void closeAll();                                        // Static function to close all main windows
     void setUniqueId( int restoreId ){ uniqueId = restoreId; } // Set up an ID that will be used during a restore
     int getUniqueId(){ return uniqueId; }
 
-    void buildRecentMenu();
-    void addWindowMenuAction( QAction* action );            // Add a gui to a 'window' menu
-    void addRecentMenuAction( QAction* action );
 
-    bool showGui( QString guiFileName, QString macroSubstitutions );
+    bool showGui( QEForm* form );                           // Ensure a GUI in this main window is visible and has focus
     void identifyWindowAndForms( int mwIndex );
+    void applyRestoredScroll();                             // Apply the gui scroll positions noted during a restore
+    void releaseGuisForReuse();                             // Offer all guis in this main window for reuse by a configuration restore
+    void park();                                            // Hide and suspend this main window, kept in a workspace not in use
+    void unpark();                                          // Show and re-activate this main window, its workspace is in use again
+    void discard();                                         // Close this main window, its workspace has been discarded
+    void applyGuiCustomisation( QString customisationName );    // Apply the window customisation required by a (non dock) gui
 
     QWidget* launchGui( QString guiName, QString title,
                         QString customisationName,
@@ -138,6 +149,10 @@ public:
 
 protected:
     void keyPressEvent( QKeyEvent* event );
+    void moveEvent( QMoveEvent* event );                    // Note layout changes for auto-save
+    void resizeEvent( QResizeEvent* event );
+    void changeEvent( QEvent* event );                      // Note layout changes, and minimising
+    bool eventFilter( QObject* watched, QEvent* event );    // Note dock layout changes for auto-save
 
 private:
     CaQtDmInterface* caQtDmInterface;                       // PSI caQtDM interface
@@ -157,6 +172,22 @@ private:
                                      Qt::DockWidgetArea allowedAreas = Qt::AllDockWidgetAreas,
                                      QDockWidget::DockWidgetFeature features = QDockWidget::DockWidgetFeatureMask,
                                      QRect geom = QRect( 0, 0, 0, 0 ) ); // Load a new gui into a new dock
+    QDockWidget* loadWidgetIntoNewDock( QWidget* widget, QString title,
+                                        bool hidden,
+                                        QE::CreationOptions createOption,
+                                        Qt::DockWidgetArea allowedAreas,
+                                        QDockWidget::DockWidgetFeature features,
+                                        QRect geom );       // Load a widget (a resizeable gui, or a placeholder for one) into a new dock
+
+    QList<guiPlaceholder*> placeholders;                    // Placeholders for guis not yet created (lazy restore)
+    bool deferPlaceholders;                                 // True while restoring, when placeholders must not be replaced yet
+    QEForm* createPlaceholderGui( guiPlaceholder* placeholder, bool isDock );  // Create the gui a placeholder stands for
+    int replacePlaceholderTab( QTabWidget* tabs, int index, guiPlaceholder* placeholder ); // Replace a placeholder tab with the gui it stands for
+    void savePlaceholder( PMElement& mw, guiPlaceholder* placeholder );  // Save details of a placeholder in a main window configuration
+
+    QList<QWidget*> getGuisInOrder();                       // Return the guis (and placeholders) in the order presented
+
+    void updateFormVisibility();                            // Let the application know which guis can be seen (so others may be suspended)
 
     MainWindow* launchLocalGui( const QString& filename, const QEFormMapper::FormHandles& formHandle );  // Launch a new gui from the 'File' menu and gui launch requests.
     MainWindow* launchLocalGui( const QString& filename,    // Launch a new gui from the requestAction slot.
@@ -170,12 +201,14 @@ private:
     QEForm* getCurrentGui();                                // Return the current gui if any (central, or tab)
     void refresh();                                         // Reload the current gui
 
-    void buildWindowsMenu();                                // Build a new 'windows' menu
+    void buildWindowsMenu();                                // Build the 'Windows' menu from all current guis
+    void buildRecentMenu();                                 // Build the 'Recent...' menu from the application's recent files
 
     void removeAllGuisFromGuiList();                    // Remove all guis on a main window from the 'windows' menus
 
 
     QString GuiFileNameDialog( QString caption );           // Get a gui filename from the user
+    QString selectConfiguration( QString caption );         // Get a saved configuration name from the user
     ContainerProfile profile;                               // Environment profile for new QE widgets
 
     QProcess process;                                       // Process used to start designer
@@ -192,12 +225,10 @@ private:
     int uniqueId;                                           // An ID unique to this window. Used when saving configuration.
 
     QScrollArea* guiScrollArea( QEForm* gui );              // Return the scroll area a gui is in if it is in one.
-    QRect setGeomRect;                                      // Parameter to setGeom() slot (This slot is called from the timer and can't take parameters)
 
     void raiseGui( QEForm* gui );                           // Raise a gui and select the right tab so the user can see it.
 
     bool beingDeleted;                                      // This main window is being deleted (deleteLater() has been called on it)
-    int waitForX11WindowManagerCount;                       // Number of times setGeom() or scrollTo() has been called waiting for geometry has been finalised
 
     QEGui* app;                                             // Application reference
 
@@ -206,11 +237,27 @@ private:
     void removeGuiFromGuiList( QEForm* gui );               // Remove a GUI from all window menus (by reference)
     void removeGuiFromGuiList( int i );                     // Remove a GUI from all window menus (by index)
     QString getCustomisationName( QEForm* gui );            // Get the customisation name used with a GUI
+    void addGuiToGuiList( QEForm* gui, QString customisationName, bool isDock ); // Add a GUI to this main window's list of GUIs (and so to all window menus)
 
+    // Moving a live gui (no reload) to another main window, or elsewhere in this main window
+    void moveGuiMenu( QEForm* gui, const QPoint& globalPos );   // Present the ways a gui may be moved, and move it as the user chooses
+    void moveGui( QEForm* gui, MainWindow* target, QE::CreationOptions createOption );  // Move a gui (to a new main window if target is NULL)
+    QWidget* releaseGui( QEForm* gui );                     // Take a gui out of this main window without deleting it
+    void adoptGui( QEForm* gui, QWidget* rGui, MainWindow* from,
+                   QString customisationName, QE::CreationOptions createOption );   // Take in a gui released by a main window
+    void redirectGuiRequests( QEForm* gui, MainWindow* from );  // Send requests from the widgets of a gui moved from another main window here
 
-private:
-    QMenu* tabMenu;                                         // ???We want to keep a reference to certain widget objects. Declaring these directly in the
+    // Reusing open guis when restoring a configuration (see QEGui::restoreConfiguration())
+    QEForm* reuseGui( QString fileName, QString macroSubstitutions, QString title,
+                      QString customisationName, QString restoreId, bool isDock );  // Reuse an offered gui rather than create it
+
+    // Keeping closed guis for reopening (see closedFormCache.h)
+    bool cacheClosedGui( QEForm* gui );                     // Keep a gui being closed. Returns false if closed guis are not kept
+    QEForm* reopenGui( QString fileName, QString restoreId,
+                       const QEFormMapper::FormHandles& formHandle );   // Reopen a kept gui rather than create it
 
+
+private:
     void newMessage( QString msg, message_types type );     // Slot to receive a message to present to the user (typically from the QE framework)
     void createActionMaps ();
 
@@ -218,6 +265,9 @@ private:
     QMenu* recentMenu;
     QMenu* editMenu;
 
+    int windowMenuGeneration;                   // Generation of the application's gui list the 'Windows' menu was built from (-1 if not built)
+    int recentMenuGeneration;                   // Generation of the application's recent file list the 'Recent...' menu was built from (-1 if not built)
+
     double windowScaling;                       // Window specific scaling above and beyond application scaling set using -a option.
 
 
@@ -267,8 +317,12 @@ private:
     void on_actionListPVNames_triggered();                      // Perform 'List PV Names'
     void on_actionScreenCapture_triggered();                    // Perfrom 'Screen Capture'
     void on_actionAbout_triggered();                            // Slot to perform 'About' action
+    void on_actionForm_Cost_Profile_triggered();                // Slot to perform 'Form Cost Profile' action
+    void on_actionForm_Profiling_triggered();                   // Slot to perform 'Form Profiling On/Off' action
+    void on_actionMove_Form_triggered();                        // Slot to perform 'Move Form...' action
     void on_actionSave_Configuration_triggered();               // Slot to perform 'Save Configuration' action
     void on_actionRestore_Configuration_triggered();            // Slot to perform 'Save Configuration' action
+    void on_actionSwitch_Workspace_triggered();                 // Slot to perform 'Switch Workspace...' action
     void on_actionSet_Passwords_triggered();
 
 private slots:
@@ -279,15 +333,13 @@ private slots:
     void tabCloseRequest( int index );                  // Slot to act on user closing a tab
 
     void tabContextMenuRequest( const QPoint & pos );   // Slot for custom tab menu requests
-    void tabContextMenuTrigger( QAction * action );     // Slot for custom tab menu actions
+    void dockContextMenuRequest( const QPoint & pos );  // Slot for custom dock menu requests
 
     void processError( QProcess::ProcessError error );  // An error occured starting designer process
 
 
     void saveRestore( SaveRestoreSignal::saveRestoreOptions option );  // A save or restore has been requested (Probably by QEGui itself)
 
-    void setGeom();                                     // Timer slot to set the window geometry on a restore
-    void scrollTo();                                    // Timer slot to set the gui scroll positions on a restore
 
     void deleteConfigs( manageConfigDialog* mcd, const QStringList names );        // Delete configurations
 
@@ -297,6 +349,16 @@ private slots:
 
     void guiDestroyed( QObject* );                      // A gui (in a dock) has been destroyed.
 
+    void layoutChanged();                               // The layout (dock location, scroll position, etc) has changed.
+
+    void dockVisibilityChanged( bool visible );         // A dock has been shown or hidden
+    void placeholderDestroyed( QObject* placeholder );  // A placeholder has gone away
+
+    void loadLevelChanged( int level );                 // The load on the GUI thread has changed (adaptive refresh governing)
+
+    void windowMenuAboutToShow();                       // Bring the 'Windows' menu up to date before it is shown
+    void recentMenuAboutToShow();                       // Bring the 'Recent...' menu up to date before it is shown
+
     // These are dummy slot methods to avoid "QObject::connect: No such slot" errors
     // when using caQtDM integration.
     void Callback_IosExit() { }
@@ -38,45 +38,123 @@
 #include <QMessageBox>
 #include <QDateTime>
 #include <caQtDmInterface.h>
+#include <startupTrace.h>
+#include <configStore.h>
+#include <benchmark.h>
+#include <QTimer>
+#include <QElapsedTimer>
 
 Q_DECLARE_METATYPE( QEForm* )
 
 // Construction
-QEGui::QEGui(int& argc, char **argv ) : QApplication( argc, argv )
+QEGui::QEGui(int& argc, char **argv ) : QApplication( argc, argv ), workspaces( this ), launches( this )
 {
+    startupTrace::markOrigin();                 // in case startup tracing is requested
     qRegisterMetaType<QEForm*>( "QEForm*" );   // must also register declared meta types.
     this->loginForm = NULL;
+    this->guiListGeneration = 0;
+    this->recentFilesGeneration = 0;
 }
 
 // Destruction - place holder
 QEGui::~QEGui() { }
 
+// Dispatch an event.
+// If the stall watchdog is enabled, note each event dispatched on the GUI thread so the
+// watchdog can report what the GUI thread was doing if it stalls.
+// If the form profiler is enabled, time the events it profiles.
+// Events dispatched on other threads are passed straight on. The watchdog and profiler
+// (including whether they are enabled) are only ever accessed on the GUI thread.
+bool QEGui::notify( QObject* receiver, QEvent* event )
+{
+    if( receiver->thread() != thread() )
+    {
+        return QApplication::notify( receiver, event );
+    }
+
+    const bool watching = watchdog.isEnabled();
+    const bool profiling = profiler.isEnabled();
+    if( !watching && !profiling )
+    {
+        return QApplication::notify( receiver, event );
+    }
+
+    stallWatchdog::eventFrame saved;
+    if( watching )
+    {
+        watchdog.enterEvent( receiver, event, saved );
+    }
+
+    const int category = profiling ? profiler.profileEvent( receiver, event ) : -1;
+    QElapsedTimer timer;
+    qint64 enclosingNested = 0;
+    if( category >= 0 )
+    {
+        enclosingNested = profiler.startCost();
+        timer.start();
+    }
+
+    const bool result = QApplication::notify( receiver, event );
+
+    if( category >= 0 )
+    {
+        profiler.addCost( receiver, category, timer.nsecsElapsed(), enclosingNested );
+    }
+    if( watching )
+    {
+        watchdog.leaveEvent( saved );
+    }
+    return result;
+}
+
+// Start or stop profiling GUI widget costs. When starting, the open GUIs are profiled.
+void QEGui::setFormProfiling( const bool enabled )
+{
+    profiler.setEnabled( enabled, openForms.getForms() );
+}
+
 // Run the application
 int QEGui::run()
 {
     // Get the startup parameters from the command line arguments
+    startupTrace::beginPhase( "parse arguments" );
     bool argsAreOkay = this->params.getStartupParams();
 
+    // Trace startup if requested. (The phase above is recorded once enabled)
+    startupTrace::enable( this->params.profileStartupFile );
+
     if (!argsAreOkay)
     {
         QEGui::printUsage (std::cerr);
+        startupTrace::complete();
         return 1;
     }
 
     if (this->params.printHelp)
     {
        QEGui::printHelp ();
+       startupTrace::complete();
        return 0;
     }
 
     if (this->params.printVersion)
     {
        QEGui::printVersion ();
+       startupTrace::complete();
        return 0;
     }
 
+    // A benchmark run must not disturb the user's configuration, or the user's QEGui.
+    // The second instances it starts (and only they) hand over to it using a private instance name.
+    const bool benchmarking = !this->params.benchmarkFile.isEmpty();
+    if( benchmarking )
+    {
+        this->params.disableAutoSaveConfiguration = true;
+        qputenv( "QEGUI_INSTANCE_NAME", QString( "benchmark_%1" ).arg( applicationPid() ).toLocal8Bit() );
+    }
 
     // Restore the user level passwords
+    startupTrace::beginPhase( "read settings" );
     QSettings settings( "epicsqt", "QEGui");
     setUserLevelPassword( QE::User, settings.value( "userPassword" ).toString() );
     setUserLevelPassword( QE::Scientist, settings.value( "scientistPassword" ).toString() );
@@ -100,6 +178,7 @@ int QEGui::run()
     }
 
     // Set up the profile for finding customisation files, and for loading customisations
+    startupTrace::beginPhase( "load customisations" );
     ContainerProfile profile;
     profile.setupProfile( NULL, params.pathList, "", this->params.substitutions );
 
@@ -146,18 +225,24 @@ int QEGui::run()
 
     // Prepare to manage save and restore
     // Note, main windows look after themselves, this is for the overall application
+    startupTrace::beginPhase( "save restore manager" );
     saveRestoreManager saveRestore( this );
 
     // If only a single instance has been requested,
     // and if there is already another instance of QEGui
     // and it takes the parameters, do no more
+    startupTrace::beginPhase( "instance manager" );
     instanceManager instance( this );
     if( params.singleApp && instance.handball( &this->params ) )
+    {
+        startupTrace::complete();
         return 0;
+    }
 
     // Define application scaling / font scaling to be applied to all widgets.
     // Recall adjustScale and fontScale  is expressed as a percentage.
     //
+    startupTrace::beginPhase( "scaling and PV lists" );
     QEScaling::setScaling( int( this->params.adjustScale ), 100 );
     QEScaling::setFontScaling( int( this->params.fontScale ), 100 );
 
@@ -173,14 +258,79 @@ int QEGui::run()
     pvNameList = startupParams::readNameList (this->params.oosPVListFile);
     QCaAlarmInfoColorNamesManager::setOosPvNameList (pvNameList);
 
+    // Suspend GUIs that can't be seen if requested
+    suspender.setEnabled( this->params.suspendHidden );
+
+    // Limit the repaint rate if requested
+    governor.setMaxRate( this->params.maxRefreshHz );
+
+    // Throttle lower priority GUIs as the load rises if requested.
+    // The first step is to suspend GUIs that can't be seen.
+    governor.setAdaptive( this->params.adaptiveRefresh );
+    QObject::connect( &governor, SIGNAL( loadLevelChanged( int ) ), &suspender, SLOT( setLoadLevel( int ) ) );
+
+    // Profile the cost of GUI widgets if requested
+    setFormProfiling( this->params.profileForms );
+
+    // Limit the memory kept by workspaces not in use
+    workspaces.setMemoryLimit( this->params.workspaceMemory );
+
+    // Keep recently closed GUIs for reopening if requested
+    closedForms.setLimit( this->params.closedFormCacheSize );
+
     // Start automatic saving of current configuration
+    startupTrace::beginPhase( "start auto save" );
     startAutoSaveConfig( this->params.configurationFile,
                          this->params.disableAutoSaveConfiguration );
 
-    // Start the main application window
-    instance.newWindow( this->params );
+    // Start the main application window, or in server mode prepare for requests from other instances.
+    // The server keeps running with no windows open.
+    startupTrace::beginPhase( "create windows" );
+    benchmark bench( this );
+    if( benchmarking )
+    {
+        bench.start( this->params.benchmarkFile, this->params.filenameList );
+    }
+    else if( this->params.serverMode )
+    {
+        setQuitOnLastWindowClosed( false );
+        instance.startServerMode( this->params );
+    }
+    else
+    {
+        instance.newWindow( this->params );
+    }
+
+    // Startup is complete when the event loop first runs (windows shown and initial events processed)
+    startupTrace::beginPhase( "first event loop" );
+    if( startupTrace::isEnabled() )
+    {
+        QTimer::singleShot( 0, startupTrace::complete );
+    }
+
+    // Watch for the GUI thread stalling if requested
+    watchdog.enable( this->params.stallThreshold );
+
     int ret = exec();
 
+    // Write the trace if the event loop exited before startup was deemed complete
+    startupTrace::complete();
+
+    // Report any stalls recorded
+    watchdog.disable();
+    const QString stalls = watchdog.getStallReport();
+    if( !stalls.isEmpty() )
+    {
+        std::cerr << "QEGui GUI thread stalls (most recent " << watchdog.getStallCount() << "):\n"
+                  << stalls.toLocal8Bit().constData();
+    }
+
+    // Don't let a benchmark run change the user's settings (recent files, for example)
+    if( benchmarking )
+    {
+        return ret;
+    }
+
     // Save passwords
     settings.setValue( "userPassword", getUserLevelPassword( QE::User ));
     settings.setValue( "scientistPassword", getUserLevelPassword( QE::Scientist ));
@@ -291,6 +441,7 @@ MainWindow* QEGui::getMainWindow( int i )
 }
 
 // Locate a main window in the application's list of main windows
+// Return -1 if not in the list (such as a pooled main window not yet in use)
 int QEGui::getMainWindowPosition( MainWindow* mw )
 {
     for( int i = 0; i < mainWindowList.count(); i++ )
@@ -299,14 +450,16 @@ int QEGui::getMainWindowPosition( MainWindow* mw )
             return i;
     }
 
-    // Should never get here
-    return 0;
+    return -1;
 }
 
 // Add a main window to the application's list of main windows
 void QEGui::addMainWindow( MainWindow* window )
 {
     mainWindowList.append( window );
+    openForms.addMainWindow( window );
+    markGuiListChanged();
+    markConfigurationChanged();
 }
 
 // Remove a main window from the application's list of main windows given a reference to the main window
@@ -319,6 +472,9 @@ void QEGui::removeMainWindow( MainWindow* window )
         if( mainWindowList[i] == window )
         {
             mainWindowList.removeAt( i );
+            openForms.removeMainWindow( window );
+            markGuiListChanged();
+            markConfigurationChanged();
             break;
         }
     }
@@ -327,7 +483,10 @@ void QEGui::removeMainWindow( MainWindow* window )
 // Remove a main window from the application's list of main windows given an index into the application's list of main windows
 void QEGui::removeMainWindow( int i )
 {
+    openForms.removeMainWindow( mainWindowList[i] );
     mainWindowList.removeAt( i );
+    markGuiListChanged();
+    markConfigurationChanged();
 }
 
 // Return list of recently added files
@@ -337,43 +496,45 @@ const QList<recentFile*>&  QEGui::getRecentFiles()
 }
 
 // If a GUI matching a filename and macro substitutions is present, ensure it is visible and has focus.
-// Return true if GUI is found
+// Failing that, if a main window matching the title is present, ensure it is visible and has focus.
+// Return the main window raised, if any.
  MainWindow* QEGui::raiseGui(  QString guiFileName, QString macroSubstitutions, QString title )
 {
-    for( int i = 0; i < mainWindowList.count(); i++ )
+    // If the guifileName and macro substitution matches, ensure the specific GUI
+    // in the main window is displayed
+    MainWindow* mw = NULL;
+    QEForm* form = openForms.findForm( guiFileName, macroSubstitutions, &mw );
+    if( form && mw && mw->showGui( form ) )
     {
-        MainWindow* mw = mainWindowList[i];
-
-        // If the guifileName and macro substitution matches, ensure the specific GUI
-        // in the main window is displayed
-        if( mw->showGui( guiFileName, macroSubstitutions ) )
-        {
-            return mw;
-        }
-
-        // If the main window title matches, then show it
-        else
-        {
-            VariableNameManager vnm;
-            vnm.setVariableNameSubstitutions( macroSubstitutions );
-            QString substitutedTitle = vnm.substituteThis( title );
-            if( mw->windowTitle() == substitutedTitle )
-            {
-                mw->setWindowState((mw->windowState() & ~Qt::WindowMinimized) | Qt::WindowActive);
-                mw->show();
-                mw->raise();
-                mw->activateWindow();
-                return mw;
-            }
-        }
+        return mw;
+    }
 
+    // If a main window title matches, then show it
+    VariableNameManager vnm;
+    vnm.setVariableNameSubstitutions( macroSubstitutions );
+    mw = openForms.findMainWindow( vnm.substituteThis( title ) );
+    if( mw )
+    {
+        mw->setWindowState((mw->windowState() & ~Qt::WindowMinimized) | Qt::WindowActive);
+        mw->show();
+        mw->raise();
+        mw->activateWindow();
+        return mw;
     }
+
     return NULL;
 }
 
 // Add a GUI to the application's list of GUIs, and to the recent menu
 void QEGui::addGui( QEForm* gui, QString customisationName )
 {
+    // If launching a number of GUIs together, add the GUI when they have all been launched
+    if( launches.isActive() )
+    {
+        launches.deferRecent( gui, customisationName );
+        return;
+    }
+
     // Note the GUI title and full file path
     QString name = gui->getQEGuiTitle();
     QString path = gui->getFullFileName();
@@ -390,28 +551,10 @@ void QEGui::addGui( QEForm* gui, QString customisationName )
             // Note the found action
             recentMenuAction = recentFiles[i];
 
-            // Promote the action to the top of all the menus it is in
-            //
-#if QT_VERSION < 0x060000
-            QList<QWidget*> assocObjects = recentMenuAction->associatedWidgets();
-#else
-            QList<QObject*> assocObjects = recentMenuAction->associatedObjects();
-#endif
-            for( int j = 0; j < assocObjects.count(); j++ )
-            {
-                QWidget* menu = qobject_cast<QWidget*>( assocObjects.value( j ) );
-                if( !menu ) continue;
-                menu->removeAction( recentMenuAction );
-                QAction* beforeAction = 0;
-                if( menu->actions().count() )
-                {
-                    beforeAction = menu->actions().at(0);
-                }
-                menu->insertAction( beforeAction, recentMenuAction );
-            }
-
-            // Promote the recent file info in the recent file list
+            // Promote the recent file info in the recent file list.
+            // The 'Recent...' menus will be rebuilt when next shown.
             recentFiles.prepend( recentFiles.takeAt( i ) );
+            recentFilesGeneration++;
 
             break;
         }
@@ -431,11 +574,8 @@ void QEGui::addGui( QEForm* gui, QString customisationName )
             delete( recentFiles.takeLast() );
         }
 
-        // For each main window, add the recent file
-        for( int i = 0; i < mainWindowList.count(); i++ )
-        {
-            mainWindowList[i]->addRecentMenuAction( rf );
-        }
+        // The 'Recent...' menus will be rebuilt when next shown
+        recentFilesGeneration++;
     }
 }
 
@@ -471,6 +611,24 @@ void QEGui::launchRecentGui( QString path, QStringList pathList,
     profile.releaseProfile();
 }
 
+// Get performance statistics for presentation to the user
+QString QEGui::getPerformanceReport()
+{
+    QString report;
+    report.append( forms.getStatistics() ).append( "\n" );
+    report.append( restoredGeometry.getStatistics() ).append( "\n" );
+    report.append( openForms.getStatistics() ).append( "\n" );
+    report.append( suspender.getStatistics() ).append( "\n" );
+    report.append( governor.getStatistics() ).append( "\n" );
+    report.append( watchdog.getStatistics() ).append( "\n" );
+    report.append( profiler.getStatistics() ).append( "\n" );
+    report.append( reusePool.getStatistics() ).append( "\n" );
+    report.append( workspaces.getStatistics() ).append( "\n" );
+    report.append( closedForms.getStatistics() ).append( "\n" );
+    report.append( launches.getStatistics() ).append( "\n" );
+    return report;
+}
+
 // Save the current configuration.
 //
 // This may be called as a result of the user requesting to save the configuration, in which
@@ -484,6 +642,9 @@ void QEGui::saveConfiguration( PersistanceManager* pm,        // Persistance man
                                const QString configName,      // Configuration name
                                const bool warnUser )          // True if this is interactive, in which case user will be notified of errors
 {
+    // Don't write the configuration file while an auto-save is writing it in the background
+    waitForAutoSaveWrite();
+
     // Give all main windows and top level QEForms (managed by this application) a unique identifier required for restoration
     int i = 0;
     MainWindow* mw;
@@ -498,7 +659,48 @@ void QEGui::saveConfiguration( PersistanceManager* pm,        // Persistance man
     // Ask the persistance manager to save the current configuration.
     // The persistance manager will signal all interested objects (including this application) that
     // they should present anything they wish to save.
-    pm->save( configFile, rootName, configName, warnUser );
+    configStore::save( pm, configFile, rootName, configName, warnUser );
+}
+
+// Restore a configuration, replacing all current main windows.
+//
+// Rather than close all current GUIs and create every GUI in the configuration from scratch,
+// the current GUIs are offered for reuse before the current main windows are closed. Each GUI
+// in the configuration matching an offered GUI (same .ui file and macro substitutions) is moved
+// into its restored main window as is, and only GUIs not already open are created.
+// Offered GUIs not in the configuration are deleted once the restore is complete.
+// Refer to formReusePool.h for details.
+void QEGui::restoreConfiguration( PersistanceManager* pm,     // Persistance manager
+                                  const QString configFile,   // Configuration file name
+                                  const QString rootName,     // XML root name
+                                  const QString configName )  // Configuration name
+{
+    // Offer the GUIs in all current main windows for reuse
+    int i = 0;
+    MainWindow* mw;
+    while( (mw = getMainWindow( i )) )
+    {
+        mw->releaseGuisForReuse();
+        i++;
+    }
+
+    // The main windows on screen are about to be replaced, so are no longer a workspace (if they were)
+    workspaces.clearCurrent();
+
+    // Close all current main windows
+    mw = getMainWindow( 0 );
+    if( mw )
+    {
+        mw->closeAll();
+    }
+
+    // Ask the persistance manager to restore a configuration.
+    // The persistance manager will signal all interested objects (including this application) that
+    // they should collect and apply restore data.
+    configStore::restore( pm, configFile, rootName, configName );
+
+    // Delete any GUIs that were not in the restored configuration
+    reusePool.clear();
 }
 
 // end
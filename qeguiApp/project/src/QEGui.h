@@ -22,6 +22,17 @@
 #include <recentFile.h>
 #include <windowCustomisation.h>
 #include <configAutoSave.h>
+#include <formCache.h>
+#include <geometryRestore.h>
+#include <formIndex.h>
+#include <formSuspender.h>
+#include <refreshGovernor.h>
+#include <stallWatchdog.h>
+#include <formProfiler.h>
+#include <formReusePool.h>
+#include <workspaceManager.h>
+#include <closedFormCache.h>
+#include <launchBatch.h>
 
 // Class representing the QEGui application
 class QEGui : public QApplication, ContainerProfile, public configAutoSave
@@ -32,6 +43,8 @@ public:
 
     int run();                                  // Main application code including call to exec()
 
+    bool notify( QObject* receiver, QEvent* event );    // Dispatch an event (noted for the stall watchdog and form profiler if enabled)
+
     startupParams* getParams();                 // Get the parsed application startup parameters
 
     int         getMainWindowCount();                       // Get the number of main windows
@@ -46,6 +59,10 @@ public:
     void        login( QWidget* fromForm );                 // Change user level
 
     const QList<recentFile*>&  getRecentFiles();            // Return list of recently added files
+    int         getRecentFilesGeneration() { return recentFilesGeneration; }   // Incremented whenever the list of recent files changes
+
+    void        markGuiListChanged() { guiListGeneration++; }             // Note a gui has been added to or removed from any main window
+    int         getGuiListGeneration() { return guiListGeneration; }      // Incremented whenever a gui is added to or removed from any main window
 
     void        launchRecentGui( QString path, QStringList pathList, QString macroSubstitutions, QString customisationName );
 
@@ -55,7 +72,21 @@ public:
     MainWindow*   raiseGui(  QString guiFileName, QString macroSubstitutions, QString title );
     const QString getCustomisationLog() { return winCustomisations.log.getLog(); }
 
+    formCache*    getFormCache() { return &forms; }     // Get the cache of resolved .ui file names
+    geometryRestore* getGeometryRestore() { return &restoredGeometry; } // Get the manager applying restored main window geometry
+    formIndex*    getFormIndex() { return &openForms; } // Get the index of open GUIs
+    formSuspender* getFormSuspender() { return &suspender; }   // Get the manager suspending GUIs that can't be seen
+    refreshGovernor* getRefreshGovernor() { return &governor; } // Get the governor limiting the repaint rate
+    formProfiler* getFormProfiler() { return &profiler; }      // Get the profiler of GUI widget costs
+    void          setFormProfiling( const bool enabled );      // Start or stop profiling GUI widget costs
+    QString       getPerformanceReport();               // Get performance statistics for presentation to the user
+
     void saveConfiguration( PersistanceManager* pm, const QString configFile, const QString rootName, const QString configName, const bool warnUser);   // Save the current configuration
+    void restoreConfiguration( PersistanceManager* pm, const QString configFile, const QString rootName, const QString configName ); // Restore a configuration, reusing any matching open GUIs
+    formReusePool* getFormReusePool() { return &reusePool; }  // Get the GUIs offered for reuse by a configuration restore
+    workspaceManager* getWorkspaceManager() { return &workspaces; }   // Get the manager of workspaces kept alive while not in use
+    closedFormCache* getClosedFormCache() { return &closedForms; }    // Get the recently closed GUIs kept for reopening
+    launchBatch* getLaunchBatch() { return &launches; }                 // Get the transaction for launching a number of GUIs together
 
     static void printVersion ();                    // Print the version info
     static void printHelp ();                       // Print help info
@@ -69,10 +100,24 @@ private:
     void addGuiToWindowsMenu( QEForm* gui );
 
     QList<recentFile*> recentFiles;                 // List of recently opened files
+    int recentFilesGeneration;                      // Incremented whenever the list of recent files changes ('Recent...' menus are rebuilt when next shown)
+    int guiListGeneration;                          // Incremented whenever a gui is added or removed ('Windows' menus are rebuilt when next shown)
 
     loginDialog* loginForm;                         // Dialog to use when changing user level. Keep one instance to maintain logout history
 
     windowCustomisationList winCustomisations;      // List of window customisations
+
+    formCache forms;                                // Cache of resolved .ui file names
+    geometryRestore restoredGeometry;               // Applies restored main window geometry
+    formIndex openForms;                            // Index of open GUIs
+    formSuspender suspender;                        // Suspends GUIs that can't be seen
+    refreshGovernor governor;                       // Limits the repaint rate
+    stallWatchdog watchdog;                         // Records GUI thread stalls
+    formProfiler profiler;                          // Profiles GUI widget costs
+    formReusePool reusePool;                        // GUIs offered for reuse by a configuration restore
+    workspaceManager workspaces;                    // Workspaces kept alive while not in use
+    closedFormCache closedForms;                    // Recently closed GUIs kept for reopening
+    launchBatch launches;                           // Transaction for launching a number of GUIs together
 };
 
 #endif // QEGUI_H
@@ -25,12 +25,49 @@ HEADERS += src/aboutDialog.h
 SOURCES += src/aboutDialog.cpp
 FORMS   += src/aboutDialog.ui
 
+HEADERS += src/benchmark.h
+SOURCES += src/benchmark.cpp
+
 HEADERS += src/caQtDmInterface.h
 SOURCES += src/caQtDmInterface.cpp
 
+HEADERS += src/closedFormCache.h
+SOURCES += src/closedFormCache.cpp
+
 HEADERS += src/configAutoSave.h
 SOURCES += src/configAutoSave.cpp
 
+HEADERS += src/configStore.h
+SOURCES += src/configStore.cpp
+
+HEADERS += src/formCache.h
+SOURCES += src/formCache.cpp
+
+HEADERS += src/formIndex.h
+SOURCES += src/formIndex.cpp
+
+HEADERS += src/formProfileDialog.h
+SOURCES += src/formProfileDialog.cpp
+FORMS   += src/formProfileDialog.ui
+
+HEADERS += src/formProfiler.h
+SOURCES += src/formProfiler.cpp
+
+HEADERS += src/formReusePool.h
+SOURCES += src/formReusePool.cpp
+
+HEADERS += src/formSuspender.h
+SOURCES += src/formSuspender.cpp
+
+HEADERS += src/geometryRestore.h
+SOURCES += src/geometryRestore.cpp
+
+HEADERS += src/guiPlaceholder.h
+SOURCES += src/guiPlaceholder.cpp
+
+HEADERS += src/launchBatch.h
+SOURCES += src/launchBatch.cpp
+
 HEADERS += src/loginDialog.h
 SOURCES += src/loginDialog.cpp
 
@@ -40,6 +77,9 @@ HEADERS += src/manageConfigDialog.h
 SOURCES += src/manageConfigDialog.cpp
 FORMS   += src/manageConfigDialog.ui
 
+HEADERS += src/refreshGovernor.h
+SOURCES += src/refreshGovernor.cpp
+
 HEADERS += src/recentFile.h
 SOURCES += src/recentFile.cpp
 
@@ -54,6 +94,15 @@ FORMS   += src/saveDialog.ui
 HEADERS += src/saveRestoreManager.h
 SOURCES += src/saveRestoreManager.cpp
 
+HEADERS += src/stallWatchdog.h
+SOURCES += src/stallWatchdog.cpp
+
+HEADERS += src/startupTrace.h
+SOURCES += src/startupTrace.cpp
+
+HEADERS += src/workspaceManager.h
+SOURCES += src/workspaceManager.cpp
+
 # These ui files are loaded at runtime as ui files, uic is not invoked.
 #
 OTHER_FILES += src/AlarmColourSelection.ui
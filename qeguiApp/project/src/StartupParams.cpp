@@ -18,6 +18,7 @@
 
 #include <QString>
 #include <QStringList>
+#include <QDataStream>
 #include <QVariant>
 #include <QDebug>
 #include <QDir>
@@ -52,6 +53,17 @@ startupParams::startupParams()
     configurationFile = "QEGuiConfig.xml";
     knownPVListFile = "";
     oosPVListFile = "";
+    profileStartupFile = "";  // not serialized
+    serverMode = false;       // not serialized
+    lazyRestore = false;      // not serialized
+    suspendHidden = false;    // not serialized
+    maxRefreshHz = 0.0;       // not serialized
+    adaptiveRefresh = false;  // not serialized
+    stallThreshold = 0.0;     // not serialized
+    profileForms = false;     // not serialized
+    benchmarkFile = "";       // not serialized
+    workspaceMemory = 512.0;  // not serialized
+    closedFormCacheSize = 0;  // not serialized
 }
 
 //------------------------------------------------------------------------------
@@ -65,10 +77,6 @@ startupParams::~startupParams() { }  // place holder
 //
 bool startupParams::getSharedParams( const QByteArray& in )
 {
-    double scaleValue;
-    char * scale;
-    int i;
-
     // Initialise parameters
     filenameList.clear();
     pathList.clear();
@@ -78,22 +86,21 @@ bool startupParams::getSharedParams( const QByteArray& in )
     knownPVListFile.clear();
     oosPVListFile.clear();
 
-    // Extract parameters from a stream of bytes.
-    int len = 0;
-    const char* d = in.constData();
+    QDataStream stream( in );
+    stream.setVersion( QDataStream::Qt_5_6 );
+
+    // Check parameters were packaged by the same version.
+    quint8 majorVersion;
+    quint8 minorVersion;
+    quint8 releaseVersion;
+    stream >> majorVersion >> minorVersion >> releaseVersion;
 
-    // Check enough buffer to contain at least the version
-    if( in.size() < 3 )
+    if( stream.status() != QDataStream::Ok )
     {
         qDebug() << "Start parameters have been received and ignored by this application as they are too short (" << in.size() << "bytes). This is not even long enough to the contain version number";
         return false;
     }
 
-    // Check parameters were packaged by the same version.
-    int majorVersion   = d[len]; len += 1;
-    int minorVersion   = d[len]; len += 1;
-    int releaseVersion = d[len]; len += 1;
-
     if( majorVersion   != (int)(QEFrameworkVersion::getMajor()) ||
         minorVersion   != (int)(QEFrameworkVersion::getMinor()) ||
         releaseVersion != (int)(QEFrameworkVersion::getRelease()) )
@@ -109,45 +116,33 @@ bool startupParams::getSharedParams( const QByteArray& in )
     }
 
     // Unpackage parameters
-    scale = (char *) &scaleValue;
-
-    for (i = 0; i < (int) sizeof (adjustScale); i++) {
-       scale [i] = d[len];    len += 1;
-    }
-    adjustScale = LIMIT_SCALE (scaleValue);
-
-    for (i = 0; i < (int) sizeof (fontScale); i++) {
-       scale [i] = d[len];    len += 1;
-    }
-    fontScale = LIMIT_SCALE (scaleValue);
-
-    enableEdit                   = (bool)(d[len]);    len += 1;
-    disableMenu                  = (bool)(d[len]);    len += 1;
-    disableStatus                = (bool)(d[len]);    len += 1;
-    disableAutoSaveConfiguration = (bool)(d[len]);    len += 1;
-    singleApp                    = (bool)(d[len]);    len += 1;
-    restore                      = (bool)(d[len]);    len += 1;
-
-    int fileCount = d[len];                   len += 1;
-    for( int i = 0; i < fileCount; i++ )
-    {
-        filenameList.append( &(d[len]) );     len += filenameList[i].size()+1;
-    }
-
-    int pathCount = d[len];                   len += 1;
-    for( int i = 0; i < pathCount; i++ )
+    double adjustScaleValue;
+    double fontScaleValue;
+
+    stream >> adjustScaleValue
+           >> fontScaleValue
+           >> enableEdit
+           >> disableMenu
+           >> disableStatus
+           >> disableAutoSaveConfiguration
+           >> singleApp
+           >> restore
+           >> filenameList
+           >> pathList
+           >> substitutions
+           >> configurationName
+           >> configurationFile
+           >> knownPVListFile
+           >> oosPVListFile;
+
+    adjustScale = LIMIT_SCALE (adjustScaleValue);
+    fontScale = LIMIT_SCALE (fontScaleValue);
+
+    if( stream.status() != QDataStream::Ok )
     {
-        pathList.append( &(d[len]) );         len += pathList[i].size()+1;
+        qDebug() << "Start parameters have been received and ignored by this application as they are incomplete (" << in.size() << "bytes)";
+        return false;
     }
-    substitutions.append( &(d[len]) );        len += substitutions.size()+1;
-
-    configurationName = QString( &(d[len]) ); len += configurationName.size()+1;
-
-    configurationFile = QString( &(d[len]) ); len += configurationFile.size()+1;
-
-    knownPVListFile = QString( &(d[len]) );   len += knownPVListFile.size()+1;
-
-    oosPVListFile = QString( &(d[len]) );     len += oosPVListFile.size()+1;
 
     return true;
 }
@@ -155,53 +150,34 @@ bool startupParams::getSharedParams( const QByteArray& in )
 //------------------------------------------------------------------------------
 // Serialize application startup parameters
 // This must match startupParams::getSharedParams()
+// Strings are serialized in full (not limited to Latin-1), and lists carry a full count.
 //
 void startupParams::setSharedParams( QByteArray& out )
 {
-    // Convert parameters into a stream of bytes.
-    int len = 0;
-    const char * scale;
-    int i;
-
-    out[len++] = QEFrameworkVersion::getMajor();
-    out[len++] = QEFrameworkVersion::getMinor();
-    out[len++] = QEFrameworkVersion::getRelease();
-
-    scale = (const char *) &adjustScale;
-    for (i = 0; i < (int) sizeof (adjustScale); i++) {
-       out[len++] = scale [i];
-    }
-
-    scale = (const char *) &fontScale;
-    for (i = 0; i < (int) sizeof (fontScale); i++) {
-       out[len++] = scale [i];
-    }
-
-    out[len++] = enableEdit;
-    out[len++] = disableMenu;
-    out[len++] = disableStatus;
-    out[len++] = disableAutoSaveConfiguration;
-    out[len++] = singleApp;
-    out[len++] = restore;
-
-    out[len++] = filenameList.count();
-    for( i = 0; i < filenameList.count(); i++ )
-    {
-        out.insert( len, filenameList[i].toLatin1() ); len += filenameList[i].size();   out[len++] = '\0';
-    }
-
-    out[len++] = pathList.count();
-    for( i = 0; i < pathList.count(); i++ )
-    {
-        out.insert( len, pathList[i].toLatin1() );     len += pathList[i].size();       out[len++] = '\0';
-    }
-
-    out.insert( len, substitutions.toLatin1() );       len += substitutions.size();     out[len++] = '\0';
-
-    out.insert( len, configurationName.toLatin1() );   len += configurationName.size(); out[len++] = '\0';
-    out.insert( len, configurationFile.toLatin1() );   len += configurationFile.size(); out[len++] = '\0';
-    out.insert( len, knownPVListFile.toLatin1() );     len += knownPVListFile.size();   out[len++] = '\0';
-    out.insert( len, oosPVListFile.toLatin1() );       len += oosPVListFile.size();     out[len++] = '\0';
+    out.clear();
+
+    QDataStream stream( &out, QIODevice::WriteOnly );
+    stream.setVersion( QDataStream::Qt_5_6 );
+
+    stream << quint8( QEFrameworkVersion::getMajor() )
+           << quint8( QEFrameworkVersion::getMinor() )
+           << quint8( QEFrameworkVersion::getRelease() );
+
+    stream << adjustScale
+           << fontScale
+           << enableEdit
+           << disableMenu
+           << disableStatus
+           << disableAutoSaveConfiguration
+           << singleApp
+           << restore
+           << filenameList
+           << pathList
+           << substitutions
+           << configurationName
+           << configurationFile
+           << knownPVListFile
+           << oosPVListFile;
 }
 
 
@@ -247,7 +223,29 @@ bool startupParams::getStartupParams()
     this->oosPVListFile   = ap.getString ("out_of_service", 'z', this->oosPVListFile);
 
     this->applicationTitle = ap.getString ("title", 't', this->applicationTitle);
-    
+
+    this->profileStartupFile = ap.getString ("profile_startup", 'g', this->profileStartupFile);
+    this->serverMode = ap.getBool ("server", 'i');
+    this->lazyRestore = ap.getBool ("lazy_restore", 'l');
+    this->suspendHidden = ap.getBool ("suspend_hidden", 'q');
+    this->maxRefreshHz = ap.getFloat ("max_refresh_hz", 'y', this->maxRefreshHz);
+    this->adaptiveRefresh = ap.getBool ("adaptive_refresh", 'A');
+    this->stallThreshold = ap.getFloat ("stall_threshold", 'S', this->stallThreshold);
+    this->profileForms = ap.getBool ("profile_forms", 'j');
+    this->benchmarkFile = ap.getString ("benchmark", 'B', this->benchmarkFile);
+    this->workspaceMemory = ap.getFloat ("workspace_memory", 'W', this->workspaceMemory);
+
+    // A GUI count - must be a whole number, not rounded from anything else.
+    //
+    ts = ap.getString ("closed_form_cache", 'C', QString::number (this->closedFormCacheSize));
+    bool isInt;
+    this->closedFormCacheSize = ts.trimmed().toInt (&isInt);
+    if (!isInt || this->closedFormCacheSize < 0) {
+        DEBUG << "closed_form_cache must be a whole number of GUIs, not:" << ts;
+        this->closedFormCacheSize = 0;
+        return false;
+    }
+
     // Option only.
     //
     this->printHelp    = opts.getBool ("help", 'h');
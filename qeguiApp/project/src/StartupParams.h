@@ -58,6 +58,17 @@ public:
     QString defaultCustomisationName;               // Default window customisation name (name of customisation in windowCustomisationFile)
     QString startupCustomisationName;               // Window customisation name for windows created at startup (name of customisation in windowCustomisationFile)
     QString applicationTitle;                       // Default application title
+    QString profileStartupFile;                     // Startup trace output file (not serialized)
+    bool serverMode;                                // Run as a pre-warmed server with no initial windows (not serialized)
+    bool lazyRestore;                               // Restore background tabs and hidden docks as placeholders, opened when first shown (not serialized)
+    bool suspendHidden;                             // Suspend PV updates to GUIs that can't be seen (not serialized)
+    double maxRefreshHz;                            // Maximum main window repaint rate, zero for no limit (not serialized)
+    bool adaptiveRefresh;                           // Throttle lower priority GUIs as the load on the GUI thread rises (not serialized)
+    double stallThreshold;                          // Record GUI thread stalls longer than this (mS), zero for no watchdog (not serialized)
+    bool profileForms;                              // Profile the cost of GUI widgets from startup (not serialized)
+    QString benchmarkFile;                          // Benchmark results output file ('-' for stdout), empty if not benchmarking (not serialized)
+    double workspaceMemory;                         // Limit on the estimated memory used by workspaces not in use (MB) (not serialized)
+    int closedFormCacheSize;                        // Number of recently closed GUIs kept for reopening, zero for none (not serialized)
 };
 
 
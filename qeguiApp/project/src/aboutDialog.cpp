@@ -66,6 +66,8 @@ aboutDialog::aboutDialog (
     int disconnectedCount,                    // Number of disconnected channels
     int connectedCount,                       // Number of connected channels
 
+    QString performanceReport,                // Performance statistics, such as form name cache hit rates
+
     QWidget* parent) :
     QEDialog (parent),
     ui (new Ui::aboutDialog)
@@ -177,6 +179,9 @@ aboutDialog::aboutDialog (
    ui->disconnectedChannelsLabel->setText (QString ("%1").arg (disconnectedCount));
    ui->connectedChannelsLabel->setText (QString ("%1").arg (connectedCount));
 
+   // Performance
+   ui->performanceTextEdit->setPlainText (performanceReport);
+
    // Allow window ui file names to be copied.
    QTableWidget* table = ui->windowsTable;      // alias
 
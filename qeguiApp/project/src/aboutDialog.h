@@ -59,6 +59,8 @@ public:
        int disconnectedCount,                  // Number of disconnected channels
        int connectedCount,                     // Number of connected channels
 
+       QString performanceReport,              // Performance statistics, such as form name cache hit rates
+
        QWidget *parent = 0);
 
    ~aboutDialog();
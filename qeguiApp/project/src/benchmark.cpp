@@ -0,0 +1,655 @@
+/*  benchmark.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+/*
+ * This class runs a benchmark of the main QEGui operations (-B option)
+ */
+
+#include "benchmark.h"
+#include <algorithm>
+#include <iostream>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QTemporaryDir>
+#include <QTimer>
+#include <QEForm.h>
+#include <QEFrameworkVersion.h>
+#include <ContainerProfile.h>
+#include <QEGui.h>
+#include <MainWindow.h>
+#include <InstanceManager.h>
+
+#define DEBUG qDebug() << "benchmark" << __LINE__ << __FUNCTION__ << "  "
+
+// Default number of times each operation is measured (QEGUI_BENCHMARK_ITERATIONS overrides).
+// Enough for a meaningful 99th percentile.
+#define BENCH_ITERATIONS  100
+
+// Number of GUIs open while measuring raiseGui()
+#define BENCH_OPEN_FORMS  20
+
+// Number of main windows in the configuration saved and restored
+#define BENCH_WINDOWS     5
+
+// Time allowed for a second instance to hand over its request and exit,
+// or to complete its startup (mS)
+#define HANDBALL_TIMEOUT  20000
+
+// Pause between launches, so a server has returned to idle (mS)
+#define LAUNCH_PAUSE      200
+
+// Name of the configuration saved and restored
+#define BENCH_CONFIG_NAME "benchmark"
+
+//------------------------------------------------------------------------------
+// Construction
+benchmark::benchmark( QEGui* appIn ) : QObject( 0 )
+{
+    app = appIn;
+    iterations = BENCH_ITERATIONS;
+}
+
+//------------------------------------------------------------------------------
+// Destruction
+benchmark::~benchmark() { }
+
+//------------------------------------------------------------------------------
+// Run the benchmark once the event loop is running
+void benchmark::start( const QString& outputFileIn, const QStringList& fileNamesIn )
+{
+    outputFile = outputFileIn;
+    fileNames = fileNamesIn;
+
+    // Use the number of iterations requested, if any
+    bool ok = false;
+    const int requested = qgetenv( "QEGUI_BENCHMARK_ITERATIONS" ).toInt( &ok );
+    if( ok && requested > 0 )
+    {
+        iterations = requested;
+    }
+
+    // Windows are opened and closed throughout
+    app->setQuitOnLastWindowClosed( false );
+
+    QTimer::singleShot( 0, this, SLOT( run() ) );
+}
+
+//------------------------------------------------------------------------------
+// Run all benchmarks, write the results, and exit the application
+void benchmark::run()
+{
+    if( fileNames.isEmpty() )
+    {
+        std::cerr << "QEGui benchmark: no .ui files specified" << std::endl;
+        QCoreApplication::exit( 1 );
+        return;
+    }
+
+    // Let any servers started by the event loop get going
+    settle();
+
+    benchCreateGui();
+    benchRaiseGui();
+    benchTabDetach();
+
+    QTemporaryDir configDir;
+    if( configDir.isValid() )
+    {
+        benchConfiguration( QDir( configDir.path() ).filePath( "QEGuiBenchmarkConfig.xml" ) );
+    }
+    else
+    {
+        std::cerr << "QEGui benchmark: could not create a temporary directory, configuration save and restore skipped" << std::endl;
+    }
+
+    benchHandball();
+    benchServerMode();
+    benchNoServer();
+
+    QCoreApplication::exit( writeResults() ? 0 : 1 );
+}
+
+//------------------------------------------------------------------------------
+// Time building each GUI from its .ui file
+void benchmark::benchCreateGui()
+{
+    MainWindow* mw = newMainWindow( "" );
+
+    for( int f = 0; f < fileNames.count(); f++ )
+    {
+        samples times;
+        for( int i = 0; i < iterations; i++ )
+        {
+            QElapsedTimer timer;
+            timer.start();
+            QEForm* gui = mw->createGui( fileNames[f], "", "", QEFormMapper::nullHandle(), true );
+            times.append( timer.nsecsElapsed() / 1000000.0 );
+
+            delete gui;
+            settle();
+        }
+        addResult( "createGui", QFileInfo( fileNames[f] ).fileName(), times );
+    }
+
+    closeWindows();
+}
+
+//------------------------------------------------------------------------------
+// Time locating and presenting an open GUI
+void benchmark::benchRaiseGui()
+{
+    MainWindow* mw = newMainWindow( fileNames[0] );
+    for( int i = 1; i < BENCH_OPEN_FORMS; i++ )
+    {
+        addTab( mw, fileNames[i % fileNames.count()] );
+    }
+    settle();
+
+    QTabWidget* tabs = mw->getCentralTabs();
+    samples times;
+    for( int i = 0; i < iterations && mw->guiList.count() > 1; i++ )
+    {
+        // Raise a GUI that is not the current tab
+        if( tabs )
+        {
+            tabs->setCurrentIndex( 0 );
+        }
+        QEForm* form = mw->guiList[( i % ( mw->guiList.count() - 1 ) ) + 1].getForm();
+        const QString fileName = form->getFullFileName();
+        const QString macroSubstitutions = form->getMacroSubstitutions();
+
+        QElapsedTimer timer;
+        timer.start();
+        app->raiseGui( fileName, macroSubstitutions, "" );
+        settle();
+        times.append( timer.nsecsElapsed() / 1000000.0 );
+    }
+    addResult( "raiseGui", QString( "%1 GUIs open" ).arg( mw->guiList.count() ), times );
+
+    closeWindows();
+}
+
+//------------------------------------------------------------------------------
+// Time detaching a tab into its own main window
+void benchmark::benchTabDetach()
+{
+    MainWindow* mw = newMainWindow( fileNames[0] );
+
+    samples times;
+    for( int i = 0; i < iterations; i++ )
+    {
+        addTab( mw, fileNames[i % fileNames.count()] );
+        settle();
+
+        QTabWidget* tabs = mw->getCentralTabs();
+        if( !tabs )
+        {
+            break;
+        }
+        tabs->setCurrentIndex( tabs->count() - 1 );
+
+        const int windows = app->getMainWindowCount();
+        QElapsedTimer timer;
+        timer.start();
+        mw->moveGui( mw->getCurrentGui(), NULL, QE::Open );
+        settle();
+        times.append( timer.nsecsElapsed() / 1000000.0 );
+
+        // Close the new main window
+        if( app->getMainWindowCount() > windows )
+        {
+            app->getMainWindow( app->getMainWindowCount() - 1 )->close();
+            settle();
+        }
+    }
+    addResult( "tabDetach", "", times );
+
+    closeWindows();
+}
+
+//------------------------------------------------------------------------------
+// Time saving and restoring a configuration of a number of main windows
+void benchmark::benchConfiguration( const QString& configFile )
+{
+    for( int i = 0; i < BENCH_WINDOWS; i++ )
+    {
+        newMainWindow( fileNames[i % fileNames.count()] );
+    }
+    settle();
+
+    ContainerProfile profile;
+    PersistanceManager* pm = profile.getPersistanceManager();
+
+    samples saveTimes;
+    samples restoreTimes;
+    samples reuseTimes;
+    for( int i = 0; i < iterations; i++ )
+    {
+        QElapsedTimer timer;
+        timer.start();
+        app->saveConfiguration( pm, configFile, QE_CONFIG_NAME, BENCH_CONFIG_NAME, false );
+        saveTimes.append( timer.nsecsElapsed() / 1000000.0 );
+
+        // Restore with all GUIs open (all reused)
+        timer.start();
+        app->restoreConfiguration( pm, configFile, QE_CONFIG_NAME, BENCH_CONFIG_NAME );
+        settle();
+        reuseTimes.append( timer.nsecsElapsed() / 1000000.0 );
+
+        // Restore with no GUIs open (all created)
+        closeWindows();
+
+        timer.start();
+        app->restoreConfiguration( pm, configFile, QE_CONFIG_NAME, BENCH_CONFIG_NAME );
+        settle();
+        restoreTimes.append( timer.nsecsElapsed() / 1000000.0 );
+
+        if( app->getMainWindowCount() == 0 )
+        {
+            std::cerr << "QEGui benchmark: configuration restore did not create any windows" << std::endl;
+            break;
+        }
+    }
+
+    const QString detail = QString( "%1 main windows" ).arg( BENCH_WINDOWS );
+    addResult( "configSave", detail, saveTimes );
+    addResult( "configRestore", detail, restoreTimes );
+    addResult( "configReuse", detail, reuseTimes );
+
+    closeWindows();
+}
+
+//------------------------------------------------------------------------------
+// Time a second instance started with -s handing its request to this instance.
+// The time is from starting the second instance until it has received
+// acknowledgement that this instance has opened the window, and exited.
+void benchmark::benchHandball()
+{
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert( "QT_QPA_PLATFORM", "offscreen" );
+
+    samples times;
+    for( int i = 0; i < iterations; i++ )
+    {
+        QStringList arguments;
+        arguments << "-s" << "-o" << fileNames[i % fileNames.count()];
+
+        double elapsed;
+        if( !runInstance( arguments, environment, elapsed ) )
+        {
+            std::cerr << "QEGui benchmark: could not start a second instance, handball skipped" << std::endl;
+            break;
+        }
+
+        // If no window was opened here, the second instance did not hand over to this instance
+        if( elapsed < 0.0 || app->getMainWindowCount() == 0 )
+        {
+            std::cerr << "QEGui benchmark: second instance did not hand over to this instance, handball skipped" << std::endl;
+            closeWindows();
+            break;
+        }
+        times.append( elapsed );
+
+        closeWindows();
+    }
+    addResult( "handball", "", times );
+}
+
+//------------------------------------------------------------------------------
+// Time a second instance started with -s handing its request to an instance
+// running in server mode (-i). The server is started with the .ui files, so
+// they have been read in advance and it has main windows ready to present them.
+// The time is from starting the second instance until it has received
+// acknowledgement that the server has opened the window, and exited.
+void benchmark::benchServerMode()
+{
+    const QString instanceName = QString( "benchmark_%1_server" ).arg( QCoreApplication::applicationPid() );
+    const QString serverName = instanceManager::serverNameFor( instanceName );
+
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert( "QT_QPA_PLATFORM", "offscreen" );
+    environment.insert( "QEGUI_INSTANCE_NAME", instanceName );
+
+    // Start the server, without automatic configuration saving
+    QProcess server;
+    server.setProcessEnvironment( environment );
+    server.start( QCoreApplication::applicationFilePath(), QStringList() << "-i" << "-o" << fileNames );
+    if( !server.waitForStarted() )
+    {
+        std::cerr << "QEGui benchmark: could not start a server mode instance, serverMode skipped" << std::endl;
+        return;
+    }
+
+    // Wait for the server to accept connections
+    bool listening = false;
+    QElapsedTimer startTimer;
+    startTimer.start();
+    while( !listening && startTimer.elapsed() < HANDBALL_TIMEOUT && server.state() == QProcess::Running )
+    {
+        QLocalSocket probe;
+        probe.connectToServer( serverName, QIODevice::WriteOnly );
+        listening = probe.waitForConnected( 100 );
+        if( !listening )
+        {
+            pause( 50 );
+        }
+    }
+
+    samples times;
+    if( listening )
+    {
+        for( int i = 0; i < iterations; i++ )
+        {
+            // Let the server return to idle (replenish its ready main windows)
+            pause( LAUNCH_PAUSE );
+
+            QStringList arguments;
+            arguments << "-s" << "-o" << fileNames[i % fileNames.count()];
+
+            double elapsed;
+            if( !runInstance( arguments, environment, elapsed ) || elapsed < 0.0 )
+            {
+                std::cerr << "QEGui benchmark: second instance did not hand over to the server mode instance, serverMode skipped" << std::endl;
+                break;
+            }
+            times.append( elapsed );
+        }
+    }
+    else
+    {
+        std::cerr << "QEGui benchmark: server mode instance did not start its server, serverMode skipped" << std::endl;
+    }
+
+    server.kill();
+    server.waitForFinished();
+    QLocalServer::removeServer( serverName );
+
+    addResult( "serverMode", "", times );
+}
+
+//------------------------------------------------------------------------------
+// Time starting an instance with -s when no other instance is running, so the
+// instance goes on to open the window itself.
+// The time is from starting the instance until its startup is complete
+// (its startup trace has been written). The time the instance spent looking
+// for another instance is also reported (instanceCheck).
+void benchmark::benchNoServer()
+{
+    QTemporaryDir traceDir;
+    if( !traceDir.isValid() )
+    {
+        std::cerr << "QEGui benchmark: could not create a temporary directory, noServer skipped" << std::endl;
+        return;
+    }
+
+    samples times;
+    samples checkTimes;
+    for( int i = 0; i < iterations; i++ )
+    {
+        // A new instance name each time, so there is never a server (or anything left over from one)
+        const QString instanceName = QString( "benchmark_%1_none_%2" ).arg( QCoreApplication::applicationPid() ).arg( i );
+        const QString traceFile = QDir( traceDir.path() ).filePath( QString( "trace_%1.json" ).arg( i ) );
+
+        QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+        environment.insert( "QT_QPA_PLATFORM", "offscreen" );
+        environment.insert( "QEGUI_INSTANCE_NAME", instanceName );
+
+        QStringList arguments;
+        arguments << "-s" << "-o" << "-g" << traceFile << fileNames[i % fileNames.count()];
+
+        QProcess process;
+        process.setProcessEnvironment( environment );
+
+        QElapsedTimer timer;
+        timer.start();
+        process.start( QCoreApplication::applicationFilePath(), arguments );
+        if( !process.waitForStarted() )
+        {
+            std::cerr << "QEGui benchmark: could not start an instance, noServer skipped" << std::endl;
+            break;
+        }
+
+        // Wait for the instance to write its startup trace
+        QJsonDocument trace;
+        double elapsed = -1.0;
+        while( timer.elapsed() < HANDBALL_TIMEOUT && process.state() == QProcess::Running )
+        {
+            QFile file( traceFile );
+            if( file.open( QIODevice::ReadOnly ) )
+            {
+                trace = QJsonDocument::fromJson( file.readAll() );
+                if( trace.isObject() )
+                {
+                    elapsed = timer.nsecsElapsed() / 1000000.0;
+                    break;
+                }
+            }
+            pause( 5 );
+        }
+
+        // The instance carries on as a QEGui in its own right. Stop it, and remove its server.
+        process.kill();
+        process.waitForFinished();
+        QLocalServer::removeServer( instanceManager::serverNameFor( instanceName ) );
+
+        if( elapsed < 0.0 )
+        {
+            std::cerr << "QEGui benchmark: instance did not complete its startup, noServer skipped" << std::endl;
+            break;
+        }
+        times.append( elapsed );
+
+        // Pick out the time spent looking for another instance (uS in the trace)
+        const QJsonArray events = trace.object().value( "traceEvents" ).toArray();
+        for( int e = 0; e < events.count(); e++ )
+        {
+            const QJsonObject event = events[e].toObject();
+            if( event.value( "name" ).toString() == "instance manager" )
+            {
+                checkTimes.append( event.value( "dur" ).toDouble() / 1000.0 );
+                break;
+            }
+        }
+    }
+    addResult( "noServer", "", times );
+    addResult( "instanceCheck", "no server running", checkTimes );
+}
+
+//------------------------------------------------------------------------------
+// Run an instance of QEGui to completion, timing it.
+// Return false if the instance could not be started.
+// The elapsed time (mS) is negative if the instance did not exit in time (it is killed).
+bool benchmark::runInstance( const QStringList& arguments, const QProcessEnvironment& environment, double& elapsed )
+{
+    QProcess process;
+    process.setProcessEnvironment( environment );
+
+    QEventLoop loop;
+    QObject::connect( &process, SIGNAL( finished( int, QProcess::ExitStatus ) ), &loop, SLOT( quit() ) );
+    QTimer::singleShot( HANDBALL_TIMEOUT, &loop, SLOT( quit() ) );
+
+    QElapsedTimer timer;
+    timer.start();
+    process.start( QCoreApplication::applicationFilePath(), arguments );
+    if( !process.waitForStarted() )
+    {
+        elapsed = -1.0;
+        return false;
+    }
+    loop.exec();
+    elapsed = timer.nsecsElapsed() / 1000000.0;
+
+    if( process.state() != QProcess::NotRunning )
+    {
+        process.kill();
+        process.waitForFinished();
+        elapsed = -1.0;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Wait a while, processing events
+void benchmark::pause( const int mS )
+{
+    QEventLoop loop;
+    QTimer::singleShot( mS, &loop, SLOT( quit() ) );
+    loop.exec();
+}
+
+//------------------------------------------------------------------------------
+// Open a main window, with a GUI if a file name is given
+MainWindow* benchmark::newMainWindow( const QString& fileName )
+{
+    startupParams* params = app->getParams();
+
+    ContainerProfile profile;
+    profile.setupProfile( NULL, params->pathList, "", params->substitutions );
+    MainWindow* mw = new MainWindow( app, fileName, "", params->startupCustomisationName,
+                                     QEFormMapper::nullHandle(), false, NULL, NULL );
+    profile.releaseProfile();
+
+    mw->show();
+    return mw;
+}
+
+//------------------------------------------------------------------------------
+// Open a GUI in a new tab of a main window (as MainWindow::launchGui() does for a new tab)
+void benchmark::addTab( MainWindow* mw, const QString& fileName )
+{
+    QEForm* gui = mw->createGui( fileName, "", "", QEFormMapper::nullHandle() );
+    if( gui )
+    {
+        if( !mw->usingTabs )
+        {
+            mw->setTabMode();
+        }
+        mw->loadGuiIntoNewTab( gui );
+    }
+}
+
+//------------------------------------------------------------------------------
+// Close all main windows
+void benchmark::closeWindows()
+{
+    MainWindow* mw = app->getMainWindow( 0 );
+    if( mw )
+    {
+        mw->closeAll();
+    }
+    settle();
+}
+
+//------------------------------------------------------------------------------
+// Process all pending events, including deferred deletes, so each measurement
+// includes the work it causes and does not include work left over from the last.
+void benchmark::settle()
+{
+    QCoreApplication::sendPostedEvents();
+    QCoreApplication::sendPostedEvents( NULL, QEvent::DeferredDelete );
+    QCoreApplication::processEvents();
+}
+
+//------------------------------------------------------------------------------
+// Return a percentile (nearest rank) of sorted samples
+double benchmark::percentile( const samples& sorted, const double fraction )
+{
+    if( sorted.isEmpty() )
+    {
+        return 0.0;
+    }
+
+    int index = int( fraction * sorted.count() + 0.999999 ) - 1;
+    if( index < 0 )
+    {
+        index = 0;
+    }
+    if( index >= sorted.count() )
+    {
+        index = sorted.count() - 1;
+    }
+    return sorted[index];
+}
+
+//------------------------------------------------------------------------------
+// Summarise the latencies of one benchmark
+void benchmark::addResult( const QString& name, const QString& detail, samples& times )
+{
+    QJsonObject result;
+    result.insert( "name", name );
+    if( !detail.isEmpty() )
+    {
+        result.insert( "detail", detail );
+    }
+    result.insert( "count", times.count() );
+
+    if( !times.isEmpty() )
+    {
+        const double first = times.first();
+        std::sort( times.begin(), times.end() );
+
+        result.insert( "first_ms", first );
+        result.insert( "median_ms", percentile( times, 0.5 ) );
+        result.insert( "p99_ms", percentile( times, 0.99 ) );
+        result.insert( "min_ms", times.first() );
+        result.insert( "max_ms", times.last() );
+    }
+
+    results.append( result );
+}
+
+//------------------------------------------------------------------------------
+// Write the results. Return true if written.
+bool benchmark::writeResults()
+{
+    QJsonObject report;
+    report.insert( "qeguiVersion", QString( QE_VERSION_STRING ) );
+    report.insert( "frameworkVersion", QEFrameworkVersion::getString() );
+    report.insert( "qtVersion", QString( qVersion() ) );
+    report.insert( "platform", QGuiApplication::platformName() );
+    report.insert( "iterations", iterations );
+    report.insert( "results", results );
+
+    const QByteArray json = QJsonDocument( report ).toJson( QJsonDocument::Indented );
+
+    if( outputFile == "-" )
+    {
+        std::cout << json.constData();
+        std::cout.flush();
+        return true;
+    }
+
+    QFile file( outputFile );
+    if( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+    {
+        std::cerr << "QEGui benchmark: could not write results to " << outputFile.toLocal8Bit().constData() << std::endl;
+        return false;
+    }
+    file.write( json );
+    file.close();
+    return true;
+}
+
+// end
@@ -0,0 +1,106 @@
+/*  benchmark.h
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+/*
+ * DESCRIPTION:
+ *
+ * Benchmark run. When requested (-B option) no windows are opened at startup.
+ * Instead, once the event loop is running, the latency of the following is
+ * measured repeatedly using the .ui files given on the command line:
+ *
+ *    createGui       building each GUI (QEForm) from its .ui file
+ *    raiseGui        locating and presenting an open GUI, with a number of GUIs open
+ *    tabDetach       detaching a tab into its own main window
+ *    configSave      saving a configuration of a number of main windows
+ *    configRestore   restoring that configuration, with no GUIs open
+ *    configReuse     restoring that configuration over itself (all open GUIs reused)
+ *    handball        a second instance started with -s handing its request to this instance
+ *    serverMode      a second instance started with -s handing its request to an instance in server mode (-i)
+ *    noServer        an instance started with -s completing its startup when no other instance is running
+ *    instanceCheck   the part of that startup spent looking for another instance
+ *
+ * Each is measured 100 times, or the number of times given by the environment
+ * variable QEGUI_BENCHMARK_ITERATIONS. The median, 99th percentile, minimum and
+ * maximum of each are written as JSON to the requested file (or stdout if '-')
+ * and the application exits.
+ *
+ * Unless a Qt platform has been explicitly chosen the offscreen platform is used,
+ * so benchmarks may be run unattended. Automatic configuration saving is disabled
+ * and the configuration save and restore use a temporary configuration file, so
+ * a benchmark run does not disturb the user's configuration. The benchmark uses a
+ * private instance name (QEGUI_INSTANCE_NAME) so the second instances it starts hand
+ * their requests to it, and not to any other QEGui the user is running. The server
+ * mode and no server instances it starts have instance names of their own, and are
+ * stopped once measured.
+ */
+
+#ifndef QEGUI_BENCHMARK_H
+#define QEGUI_BENCHMARK_H
+
+#include <QObject>
+#include <QJsonArray>
+#include <QProcessEnvironment>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+class QEGui;
+class MainWindow;
+
+// Class running a benchmark of the main QEGui operations
+class benchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit benchmark( QEGui* appIn );
+    ~benchmark();
+
+    // Run the benchmark once the event loop is running, then exit the application
+    void start( const QString& outputFileIn, const QStringList& fileNamesIn );
+
+private:
+    typedef QList<double> samples;                      // Latencies (mS)
+
+    void benchCreateGui();
+    void benchRaiseGui();
+    void benchTabDetach();
+    void benchConfiguration( const QString& configFile );
+    void benchHandball();
+    void benchServerMode();
+    void benchNoServer();
+
+    bool runInstance( const QStringList& arguments, const QProcessEnvironment& environment, double& elapsed );  // Run (and time) another QEGui
+
+    MainWindow* newMainWindow( const QString& fileName );   // Open a main window (with a GUI if a file name is given)
+    void addTab( MainWindow* mw, const QString& fileName );  // Open a GUI in a new tab of a main window
+    void closeWindows();                                // Close all main windows
+
+    void addResult( const QString& name, const QString& detail, samples& times );
+    bool writeResults();
+
+    static void settle();                               // Process all pending events (including deferred deletes)
+    static void pause( const int mS );                  // Wait a while, processing events
+    static double percentile( const samples& sorted, const double fraction );
+
+    QEGui* app;
+    QString outputFile;                                 // JSON results file, or '-' for stdout
+    QStringList fileNames;                              // .ui files to benchmark with
+    int iterations;                                     // Number of times each operation is measured
+    QJsonArray results;                                 // Result of each benchmark
+
+private slots:
+    void run();                                         // Run all benchmarks, write the results, and exit
+};
+
+#endif // QEGUI_BENCHMARK_H
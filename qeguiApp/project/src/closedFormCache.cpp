@@ -0,0 +1,138 @@
+/*  closedFormCache.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+// Keep recently closed GUIs for instant reopening. Refer to closedFormCache.h for details.
+
+#include "closedFormCache.h"
+#include <QEForm.h>
+
+//------------------------------------------------------------------------------
+// Construction
+closedFormCache::closedFormCache()
+{
+    maxForms = 0;
+    hits = 0;
+    misses = 0;
+    evictions = 0;
+}
+
+closedFormCache::~closedFormCache()
+{
+    for( int i = 0; i < entries.count(); i++ )
+    {
+        delete entries[i].rGui;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Set the number of closed GUIs kept. Zero disables the cache (and deletes any GUIs kept)
+void closedFormCache::setLimit( const int maxFormsIn )
+{
+    maxForms = qMax( maxFormsIn, 0 );
+    applyLimit();
+}
+
+//------------------------------------------------------------------------------
+// Keep a closed GUI
+void closedFormCache::add( const QString& key, QEForm* form, QWidget* rGui, const QList<QPointer<QObject> >& senders )
+{
+    cacheEntry entry;
+    entry.key = key;
+    entry.form = form;
+    entry.rGui = rGui;
+    entry.senders = senders;
+    entries.prepend( entry );
+
+    applyLimit();
+}
+
+//------------------------------------------------------------------------------
+// Take a closed GUI matching a key. Returns NULL if none.
+QEForm* closedFormCache::take( const QString& key, QList<QPointer<QObject> >* senders )
+{
+    for( int i = 0; i < entries.count(); i++ )
+    {
+        if( entries[i].key != key )
+        {
+            continue;
+        }
+
+        cacheEntry entry = entries.takeAt( i );
+        if( !entry.form || !entry.rGui )
+        {
+            // Deleted since it was closed (unlikely). Look for another.
+            i--;
+            continue;
+        }
+
+        hits++;
+        if( senders )
+        {
+            *senders = entry.senders;
+        }
+        return entry.form;
+    }
+
+    misses++;
+    return NULL;
+}
+
+//------------------------------------------------------------------------------
+// Delete any closed GUIs from a .ui file
+void closedFormCache::invalidate( const QString& fullFileName )
+{
+    for( int i = entries.count() - 1; i >= 0; i-- )
+    {
+        if( !entries[i].form || entries[i].form->getFullFileName() == fullFileName )
+        {
+            cacheEntry entry = entries.takeAt( i );
+            delete entry.rGui;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// Delete the least recently closed GUIs while over the limit
+void closedFormCache::applyLimit()
+{
+    while( entries.count() > maxForms )
+    {
+        cacheEntry entry = entries.takeLast();
+        if( entry.rGui )
+        {
+            evictions++;
+            delete entry.rGui;      // Deletes the GUI with its scroll area, if any
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// Summary suitable for presenting to the user
+QString closedFormCache::getStatistics() const
+{
+    if( !isEnabled() && !hits && !misses )
+    {
+        return QString( "Closed GUI cache: not enabled (-C option)." );
+    }
+
+    const int lookups = hits + misses;
+    return QString( "Closed GUI cache: %1 GUIs kept (limit %2), %3 opened from the cache, %4 not cached (%5% hit rate), %6 evicted." )
+               .arg( entries.count() )
+               .arg( maxForms )
+               .arg( hits )
+               .arg( misses )
+               .arg( lookups ? 100.0 * hits / lookups : 0.0, 0, 'f', 0 )
+               .arg( evictions );
+}
+
+// end
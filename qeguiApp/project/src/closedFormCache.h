@@ -0,0 +1,90 @@
+/*  closedFormCache.h
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+/*
+ * DESCRIPTION:
+ *
+ * When requested (-C option) this class keeps the GUIs most recently closed by
+ * the user, so reopening the same GUI is instant.
+ *
+ * A GUI closed by closing its tab, by 'File' -> 'Close', or by closing its main
+ * window (other than the last main window, when the application exits) is not
+ * deleted. Instead it is released from its main window as is, suspended (refer
+ * to formSuspender.h) so its widgets stop receiving PV updates, and kept here.
+ * The widgets that were sending requests (to launch other GUIs, for example) to
+ * the main window are noted and disconnected from it.
+ *
+ * When a GUI is next opened with the same .ui file and macro substitutions (refer
+ * to formIndex::formKey()) the cached GUI is taken and re-activated, which
+ * reconnects its widgets and presents the latest values straight away. The .ui
+ * file is not read and no widgets are created. The widgets noted as sending
+ * requests are connected to the main window the GUI is reopened in.
+ *
+ * The number of GUIs kept is limited. When the limit is reached the least
+ * recently closed GUI is deleted. Hits, misses and evictions are counted so the
+ * effect can be confirmed from the 'About' dialog.
+ */
+
+#ifndef QEGUI_CLOSED_FORM_CACHE_H
+#define QEGUI_CLOSED_FORM_CACHE_H
+
+#include <QList>
+#include <QPointer>
+#include <QString>
+#include <QWidget>
+
+class QEForm;
+
+// Class keeping recently closed GUIs for instant reopening
+class closedFormCache
+{
+public:
+    closedFormCache();
+    ~closedFormCache();
+
+    void setLimit( const int maxFormsIn );              // Set the number of closed GUIs kept. Zero disables the cache
+    bool isEnabled() const { return maxForms > 0; }
+
+    // Keep a closed GUI released from a main window. rGui is the widget holding the GUI (the GUI itself or its scroll area).
+    // senders are the objects of the GUI that were sending requests to the main window.
+    void add( const QString& key, QEForm* form, QWidget* rGui, const QList<QPointer<QObject> >& senders );
+
+    // Take a closed GUI matching a key (see formIndex::formKey()). Returns NULL if none.
+    // If found, the objects of the GUI that were sending requests to the main window it was closed in are also returned.
+    QEForm* take( const QString& key, QList<QPointer<QObject> >* senders );
+
+    void invalidate( const QString& fullFileName );     // Delete any closed GUIs from a .ui file (the file is to be read afresh)
+
+    QString getStatistics() const;                      // Summary suitable for presenting to the user
+
+private:
+    class cacheEntry
+    {
+    public:
+        QString key;                                    // Key (canonical path and normalised macro substitutions)
+        QPointer<QEForm> form;                          // The closed GUI
+        QPointer<QWidget> rGui;                         // Widget holding the GUI (the GUI itself or its scroll area)
+        QList<QPointer<QObject> > senders;              // Objects of the GUI that were sending requests to the main window it was closed in
+    };
+
+    void applyLimit();                                  // Delete the least recently closed GUIs while over the limit
+
+    QList<cacheEntry> entries;                          // Closed GUIs, most recently closed first
+    int maxForms;                                       // Number of closed GUIs kept
+
+    int hits;                                           // Number of GUIs opened from the cache
+    int misses;                                         // Number of GUIs opened that were not cached
+    int evictions;                                      // Number of closed GUIs deleted to stay within the limit
+};
+
+#endif // QEGUI_CLOSED_FORM_CACHE_H
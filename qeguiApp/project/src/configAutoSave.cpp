@@ -13,30 +13,188 @@
 
 #include "configAutoSave.h"
 #include <persistanceManager.h>
+#include <configStore.h>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutexLocker>
+#include <QSaveFile>
+
+#define DEBUG qDebug() << "configAutoSave" << __LINE__ << __FUNCTION__ << "  "
 
 #define CONFIG_AUTO_SAVE_NAME "AutoSave"
 #define CONFIG_EXIT_SAVE_NAME "ExitSave"
 
+// Auto-save interval, and the number of intervals an auto-save may be skipped when
+// the layout is unchanged (QE widgets may have changed their own state).
+#define AUTO_SAVE_INTERVAL      30000
+#define MAX_UNCHANGED_INTERVALS 10
+
+// Number of times a capture is repeated in a row because the configuration file keeps being changed by something else
+#define MAX_STALE_RETRIES       3
+
 // Called by timer when an auto-save is due
 void configAutoSaveSlots::save()
 {
     owner->save( CONFIG_AUTO_SAVE_NAME );
 }
 
+// Called when the writer thread has finished
+void configAutoSaveSlots::writeFinished()
+{
+    owner->writeFinished();
+}
+
+// Writer thread.
+// If the configuration file is still what the shadow copy was based on, copy the shadow copy to a
+// temporary file alongside the configuration file, then rename it over the configuration file.
+// Readers never see a partly written file.
+// If the configuration file has been changed by something else, don't overwrite the change.
+// Refresh the shadow copy from the configuration file instead, so the configuration can be captured into it again.
+void configAutoSaveWriter::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    bool ok = false;
+    bool isStale = false;
+    qint64 writeElapsed = 0;
+    qint64 commitElapsed = 0;
+
+    // Read the configuration file as it is now. No configuration file, no content.
+    QByteArray current;
+    bool readOk = true;
+    QFile target( targetFile );
+    if( target.exists() )
+    {
+        readOk = target.open( QIODevice::ReadOnly );
+        current = target.readAll();
+        target.close();
+    }
+    const QByteArray currentHash = QCryptographicHash::hash( current, QCryptographicHash::Sha1 );
+
+    if( readOk && currentHash != baseHash )
+    {
+        // Changed by something else (or not read before). Refresh the shadow copy, keeping its name and permissions.
+        isStale = true;
+        QFile shadowCopy( sourceFile );
+        if( shadowCopy.open( QIODevice::WriteOnly | QIODevice::Truncate ) && shadowCopy.write( current ) == current.size() )
+        {
+            baseHash = currentHash;
+            ok = true;
+        }
+    }
+    else if( readOk )
+    {
+        QFile source( sourceFile );
+        if( source.open( QIODevice::ReadOnly ) )
+        {
+            const QByteArray content = source.readAll();
+            source.close();
+
+            QSaveFile saveFile( targetFile );
+            if( saveFile.open( QIODevice::WriteOnly ) && saveFile.write( content ) == content.size() )
+            {
+                writeElapsed = timer.restart();
+                ok = saveFile.commit();
+                commitElapsed = timer.elapsed();
+            }
+            else
+            {
+                saveFile.cancelWriting();
+            }
+
+            // The shadow copy is now the base of the configuration file (if written)
+            baseHash = ok ? QCryptographicHash::hash( content, QCryptographicHash::Sha1 ) : QByteArray();
+        }
+    }
+
+    // Publish the results
+    QMutexLocker locker( &resultsMutex );
+    writeOk = ok;
+    stale = isStale;
+    writeTime = writeElapsed;
+    commitTime = commitElapsed;
+}
+
+// Get the results of the last write
+void configAutoSaveWriter::getResults( bool& ok, bool& staleOut, qint64& writeTimeOut, qint64& commitTimeOut )
+{
+    QMutexLocker locker( &resultsMutex );
+    ok = writeOk;
+    staleOut = stale;
+    writeTimeOut = writeTime;
+    commitTimeOut = commitTime;
+}
+
 
 // Configuration Auto Save construction
 configAutoSave::configAutoSave()
 {
     running = false;
+    configurationChanged = true;
+    unchangedCount = 0;
+    skippedCount = 0;
+    staleRetries = 0;
+    staleCount = 0;
+    savePending = false;
+    coalescedCount = 0;
+    captureTime = 0;
+    maxCaptureTime = 0;
+    maxWriteTime = 0;
 
     mySlots = new configAutoSaveSlots( this );
     QObject::connect( &timer, SIGNAL(timeout()), mySlots, SLOT(save()));
+    QObject::connect( &writer, SIGNAL(finished()), mySlots, SLOT(writeFinished()));
 }
 
 
 // Configuration Auto Save destruction
 configAutoSave::~configAutoSave()
 {
+    // The shadow copy is removed as it is destroyed
+    writer.wait();
+}
+
+// Set the file to write for a named configuration, and the local shadow copy of it.
+// This is the configuration file itself, unless the configuration file is a directory store.
+// Return false if there is no shadow copy to save the configuration to.
+bool configAutoSave::setTarget( const QString configName )
+{
+    // Create the shadow copy the first time a target is set. It is uniquely named, in the local
+    // temporary directory, and readable only by the user. It is re-used for any later target.
+    if( shadowFile.isEmpty() )
+    {
+        shadow.setFileTemplate( QDir( QDir::tempPath() ).filePath( "QEGuiConfigShadow_XXXXXX.xml" ) );
+        if( !shadow.open() )
+        {
+            DEBUG << "Could not create configuration shadow copy" << shadow.fileTemplate();
+            return false;
+        }
+        shadowFile = shadow.fileName();
+        shadow.close();
+    }
+
+    const QString target = configStore::configurationFile( configFile, configName );
+    if( target == targetFile )
+    {
+        return true;
+    }
+
+    // A directory store may not exist yet
+    if( configStore::isDirectoryStore( configFile ) )
+    {
+        QDir().mkpath( configFile );
+    }
+
+    targetFile = target;
+
+    // The shadow copy is not based on the new target. The writer refreshes it from the target before the first write.
+    writer.forgetBase();
+
+    return true;
 }
 
 // Start automatic saving of current configuration if required
@@ -48,7 +206,7 @@ void configAutoSave::startAutoSaveConfig( const QString configFileIn, const bool
     // Start saving every 30 seconds if enabled
     if( !disableAutoSaveConfiguration )
     {
-        timer.start( 30000 );
+        timer.start( AUTO_SAVE_INTERVAL );
         running = true;
     }
     else
@@ -70,14 +228,23 @@ void configAutoSave::stopAutoSaveConfig()
     // Ensure no more timer events unless restarted
     timer.stop();
 
-    // Save the current configuration as the configuration at the time the application was neatly shut down
-    save( CONFIG_EXIT_SAVE_NAME );
+    // Complete any write in progress. Any pending save is superseded by the exit save.
+    savePending = false;
+    waitForAutoSaveWrite();
 
-    // Remove any auto saved configuration
-    PersistanceManager* pm = profile.getPersistanceManager();
-    QStringList names;
-    names.append( CONFIG_AUTO_SAVE_NAME );
-    pm->deleteConfigs( configFile, QE_CONFIG_NAME, names, false );
+    // Save the current configuration as the configuration at the time the application
+    // was neatly shut down, and remove any auto saved configuration.
+    // Wait for it to complete (the application is about to exit)
+    capture( CONFIG_EXIT_SAVE_NAME );
+    waitForAutoSaveWrite();
+
+    if( configStore::isDirectoryStore( configFile ) )
+    {
+        // Each configuration has its own file. Remove the auto save file.
+        QStringList names;
+        names.append( CONFIG_AUTO_SAVE_NAME );
+        configStore::deleteConfigs( profile.getPersistanceManager(), configFile, QE_CONFIG_NAME, names, false );
+    }
 
     // Flag not running
     running = false;
@@ -102,6 +269,35 @@ QString configAutoSave::getAutoSaveConfigStatus()
         {
             status += "No configuration has been saved yet.";
         }
+
+        if( skippedCount )
+        {
+            status += QString( " %1 auto-saves skipped as the layout was unchanged." ).arg( skippedCount );
+        }
+
+        if( lastSave.isValid() )
+        {
+            bool writeOk;
+            bool stale;
+            qint64 writeTime;
+            qint64 commitTime;
+            writer.getResults( writeOk, stale, writeTime, commitTime );
+
+            status += QString( " Last save: capture %1 mS (GUI thread), write %2 mS, rename %3 mS (worker thread)."
+                               " Maximum: capture %4 mS, write and rename %5 mS." )
+                          .arg( captureTime ).arg( writeTime ).arg( commitTime )
+                          .arg( maxCaptureTime ).arg( maxWriteTime );
+        }
+
+        if( coalescedCount )
+        {
+            status += QString( " %1 saves coalesced while a write was in progress." ).arg( coalescedCount );
+        }
+
+        if( staleCount )
+        {
+            status += QString( " %1 saves repeated as the configuration file had been changed elsewhere." ).arg( staleCount );
+        }
     }
 
     // Build not running message
@@ -122,13 +318,127 @@ QString configAutoSave::getAutoSaveConfigName()
 // Called as a timer event when an auto-save is due
 void configAutoSave::save( const QString configName )
 {
-    PersistanceManager* pm = profile.getPersistanceManager();
+    // Skip a periodic save if nothing has changed (unless it is a long time since the last save).
+    // The final save on exit is always made.
+    if( configName == CONFIG_AUTO_SAVE_NAME && !configurationChanged &&
+        unchangedCount < MAX_UNCHANGED_INTERVALS - 1 )
+    {
+        unchangedCount++;
+        skippedCount++;
+        return;
+    }
+    configurationChanged = false;
+    unchangedCount = 0;
+
+    // If a write is in progress, save once it completes
+    if( writer.isRunning() )
+    {
+        if( savePending )
+        {
+            coalescedCount++;
+        }
+        savePending = true;
+        pendingConfigName = configName;
+        return;
+    }
+
+    capture( configName );
+}
+
+// Capture the configuration to the shadow copy (GUI thread), then start writing it to the configuration file (worker thread)
+void configAutoSave::capture( const QString configName )
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    if( !setTarget( configName ) )
+    {
+        return;
+    }
 
     // Save the configuration according to the user's requirements
-    saveConfiguration( pm, configFile, QE_CONFIG_NAME, configName, false );
+    PersistanceManager* pm = profile.getPersistanceManager();
+    saveConfiguration( pm, shadowFile, QE_CONFIG_NAME, configName, false );
+
+    // On exit, with all configurations in the one file, remove the auto saved configuration
+    // from the shadow copy too, so the configuration file is only written once.
+    if( configName == CONFIG_EXIT_SAVE_NAME && !configStore::isDirectoryStore( configFile ) )
+    {
+        QStringList names;
+        names.append( CONFIG_AUTO_SAVE_NAME );
+        pm->deleteConfigs( shadowFile, QE_CONFIG_NAME, names, false );
+    }
+
+    // If the configuration has its own file, ensure it is listed
+    configStore::noteSaved( pm, configFile, QE_CONFIG_NAME, configName );
+
+    captureTime = timer.elapsed();
+    maxCaptureTime = qMax( maxCaptureTime, captureTime );
+
+    // Write it
+    writingConfigName = configName;
+    writer.sourceFile = shadowFile;
+    writer.targetFile = targetFile;
+    writer.start();
 
     // Note when configuration was last saved
     lastSave = QDateTime::currentDateTime();
-    getAutoSaveConfigStatus();
 }
 
+// A configuration file write has completed
+void configAutoSave::writeFinished()
+{
+    // Only called once per write
+    if( writer.isRunning() || writer.targetFile.isEmpty() )
+    {
+        return;
+    }
+
+    bool writeOk;
+    bool stale;
+    qint64 writeTime;
+    qint64 commitTime;
+    writer.getResults( writeOk, stale, writeTime, commitTime );
+    writer.targetFile.clear();
+
+    if( !writeOk )
+    {
+        DEBUG << "Could not write configuration file" << targetFile;
+    }
+    else if( stale )
+    {
+        // The configuration file had been changed by something else, so nothing was written and the
+        // shadow copy has been refreshed from it. Capture the configuration into it again (within reason).
+        staleCount++;
+        if( running && staleRetries < MAX_STALE_RETRIES )
+        {
+            staleRetries++;
+            capture( writingConfigName );
+            return;
+        }
+        DEBUG << "Configuration file keeps changing, not saved" << targetFile;
+    }
+    else
+    {
+        maxWriteTime = qMax( maxWriteTime, writeTime + commitTime );
+    }
+    staleRetries = 0;
+
+    // Make any save requested while the write was in progress
+    if( savePending && running )
+    {
+        savePending = false;
+        capture( pendingConfigName );
+    }
+}
+
+// Wait for any configuration file write in progress (and any pending save it leads to).
+// Used before anything else writes the configuration file.
+void configAutoSave::waitForAutoSaveWrite()
+{
+    while( writer.isRunning() )
+    {
+        writer.wait();
+        writeFinished();
+    }
+}
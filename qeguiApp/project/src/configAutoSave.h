@@ -24,6 +24,29 @@
  *
  * The standard configuration save/restore mechanism available to the user
  * is used to implement this auto save function.
+ *
+ * To avoid needlessly rebuilding and rewriting the configuration, the application
+ * notes when the layout changes (main windows and docks moved, resized or changed
+ * state, tabs changed, GUIs opened or closed, etc) using markConfigurationChanged().
+ * A periodic auto-save is skipped if nothing has changed. As QE widgets may also
+ * save their own state, which is not tracked, a save is still made occasionally.
+ *
+ * Configuration files often live on network file systems, so auto-saves do not
+ * read or write them from the GUI thread. The GUI thread captures the configuration
+ * into a shadow copy of the configuration file on the local temporary directory (a
+ * uniquely named file private to this QEGui, so QEGuis sharing a configuration file
+ * don't share a shadow copy), then a worker thread copies the shadow copy to a
+ * temporary file alongside the configuration file and renames it over the
+ * configuration file. A save requested while a write is in progress is coalesced
+ * with any others and made once the write completes.
+ *
+ * The configuration file may be shared, and changed by anything else (an interactive
+ * save, or another QEGui). Before writing, the worker reads the configuration file and
+ * compares a hash of its content with that of the content the shadow copy was based on
+ * (what was last written or read). If they differ it writes nothing, refreshes the
+ * shadow copy from the configuration file instead, and the configuration is captured
+ * again into the refreshed shadow copy and written. (A change made between the worker
+ * reading the configuration file and renaming over it is still lost.)
  */
 
 #ifndef CONFIGAUTOSAVE_H
@@ -31,10 +54,42 @@
 
 #include <QTimer>
 #include <QDateTime>
+#include <QMutex>
+#include <QTemporaryFile>
+#include <QThread>
 #include <ContainerProfile.h>
 
 class configAutoSave;
 
+// Thread writing the shadow copy of the configuration file over the configuration file
+class configAutoSaveWriter: public QThread
+{
+public:
+    explicit configAutoSaveWriter() { writeOk = false; stale = false; writeTime = 0; commitTime = 0; }
+
+    QString sourceFile;                 // Shadow copy (set before starting)
+    QString targetFile;                 // Configuration file (set before starting)
+
+    // Get the results of the last write. May be called while a write is in progress.
+    // If stale, nothing was written as the configuration file had been changed by something else,
+    // and the shadow copy has been refreshed from it.
+    void getResults( bool& ok, bool& staleOut, qint64& writeTimeOut, qint64& commitTimeOut );
+
+    void forgetBase() { baseHash.clear(); } // The shadow copy is not based on the target file (only call while not running)
+
+protected:
+    void run();
+
+private:
+    QByteArray baseHash;                // Hash of the target file content the shadow copy is based on (empty if unknown)
+
+    QMutex resultsMutex;                // Protects the results, which are set by the writer thread
+    bool writeOk;                       // Results of the last write
+    bool stale;                         // True if the target file had changed, so the shadow copy was refreshed instead
+    qint64 writeTime;                   // Time to write the temporary file (mS)
+    qint64 commitTime;                  // Time to rename the temporary file over the configuration file (mS)
+};
+
 class configAutoSaveSlots: public QObject
 {
     Q_OBJECT
@@ -45,6 +100,7 @@ public:
 
 public slots:
     void save();  // Called when an auto-save is due
+    void writeFinished();  // Called when a configuration file write completes
 
 };
 
@@ -58,8 +114,12 @@ public:
     void stopAutoSaveConfig();
     QString getAutoSaveConfigStatus();
 
+    void markConfigurationChanged() { configurationChanged = true; } // Note the layout has changed since the last save
+
     virtual void saveConfiguration( PersistanceManager* pm, const QString configFile, const QString rootName, const QString configName, const bool warnUser  ) = 0; // Overridden in QEGui.h
     void save( const QString configName );                        // Called when an auto-save is due (including on exit)
+    void writeFinished();                                         // Called when a configuration file write completes
+    void waitForAutoSaveWrite();                                  // Wait for any configuration file write in progress
 
     QString getAutoSaveConfigName();
 
@@ -69,6 +129,26 @@ private:
     QString configFile;
     bool running;
     QDateTime lastSave;
+    bool configurationChanged;          // True if the layout has changed since the last save
+    int unchangedCount;                 // Number of consecutive auto-saves skipped as the layout was unchanged
+    int skippedCount;                   // Total number of auto-saves skipped
+
+    void capture( const QString configName );   // Capture the configuration to the shadow copy and start writing it
+    bool setTarget( const QString configName ); // Set the file to write for a named configuration, and its shadow copy
+
+    configAutoSaveWriter writer;        // Thread writing the configuration file
+    QString targetFile;                 // File being written (the configuration file, or for a directory store the configuration's file)
+    QTemporaryFile shadow;              // Local shadow copy of the target file (removed on destruction)
+    QString shadowFile;                 // Name of the shadow copy
+    QString writingConfigName;          // Configuration being written
+    int staleRetries;                   // Consecutive captures repeated as the target file was changed by something else
+    int staleCount;                     // Total number of captures repeated as the target file was changed by something else
+    bool savePending;                   // True if a save was requested while a write was in progress
+    QString pendingConfigName;
+    int coalescedCount;                 // Number of saves coalesced while a write was in progress
+    qint64 captureTime;                 // Latency of the last save's stages (mS)
+    qint64 maxCaptureTime;
+    qint64 maxWriteTime;
     ContainerProfile profile;           // Environment profile for QE applications and QE widgets
 
 };
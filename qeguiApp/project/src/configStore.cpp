@@ -0,0 +1,257 @@
+/*  configStore.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+// Configuration storage. Refer to configStore.h for details.
+
+#include "configStore.h"
+#include <persistanceManager.h>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QTextStream>
+
+#define DEBUG qDebug() << "configStore" << __LINE__ << __FUNCTION__ << "  "
+
+#define DIRECTORY_STORE_SUFFIX  ".d"
+#define INDEX_FILE_NAME         "index.txt"
+
+//------------------------------------------------------------------------------
+// Return true if the configuration file is a directory store
+bool configStore::isDirectoryStore( const QString& configFile )
+{
+    return configFile.endsWith( DIRECTORY_STORE_SUFFIX ) || QFileInfo( configFile ).isDir();
+}
+
+//------------------------------------------------------------------------------
+// Return the file holding a named configuration.
+// In a directory store the file name is a readable form of the configuration name
+// followed by part of a hash of the name (so different names never share a file).
+QString configStore::configurationFile( const QString& configFile, const QString& configName )
+{
+    if( !isDirectoryStore( configFile ) )
+    {
+        return configFile;
+    }
+
+    static const QRegularExpression unsafeCharacters( "[^A-Za-z0-9_-]" );
+
+    QString readable = configName;
+    readable.replace( unsafeCharacters, "_" );
+    const QByteArray nameHash = QCryptographicHash::hash( configName.toUtf8(), QCryptographicHash::Sha1 ).toHex().left( 8 );
+
+    return QDir( configFile ).filePath( QString( "%1_%2.xml" ).arg( readable.left( 64 ) ).arg( QString::fromLatin1( nameHash ) ) );
+}
+
+//------------------------------------------------------------------------------
+// Record that a named configuration has been saved to its file.
+// The index is only rewritten when a configuration is added.
+void configStore::noteSaved( PersistanceManager* pm, const QString& configFile, const QString& rootName, const QString& configName )
+{
+    if( !isDirectoryStore( configFile ) )
+    {
+        return;
+    }
+
+    indexList index = readIndex( pm, configFile, rootName );
+    for( int i = 0; i < index.count(); i++ )
+    {
+        if( index[i].second == configName )
+        {
+            return;
+        }
+    }
+
+    index.append( qMakePair( QFileInfo( configurationFile( configFile, configName ) ).fileName(), configName ) );
+    writeIndex( configFile, index );
+}
+
+//------------------------------------------------------------------------------
+// Save a named configuration
+void configStore::save( PersistanceManager* pm, const QString& configFile, const QString& rootName,
+                        const QString& configName, const bool warnUser )
+{
+    if( !isDirectoryStore( configFile ) )
+    {
+        pm->save( configFile, rootName, configName, warnUser );
+        return;
+    }
+
+    QDir().mkpath( configFile );
+    pm->save( configurationFile( configFile, configName ), rootName, configName, warnUser );
+    noteSaved( pm, configFile, rootName, configName );
+}
+
+//------------------------------------------------------------------------------
+// Restore a named configuration
+void configStore::restore( PersistanceManager* pm, const QString& configFile, const QString& rootName,
+                           const QString& configName )
+{
+    pm->restore( configurationFile( configFile, configName ), rootName, configName );
+}
+
+//------------------------------------------------------------------------------
+// Delete named configurations
+void configStore::deleteConfigs( PersistanceManager* pm, const QString& configFile, const QString& rootName,
+                                 const QStringList& names, const bool warnUser )
+{
+    if( !isDirectoryStore( configFile ) )
+    {
+        pm->deleteConfigs( configFile, rootName, names, warnUser );
+        return;
+    }
+
+    indexList index = readIndex( pm, configFile, rootName );
+    for( int i = 0; i < names.count(); i++ )
+    {
+        QFile::remove( configurationFile( configFile, names[i] ) );
+
+        for( int j = index.count() - 1; j >= 0; j-- )
+        {
+            if( index[j].second == names[i] )
+            {
+                index.removeAt( j );
+            }
+        }
+    }
+    writeIndex( configFile, index );
+}
+
+//------------------------------------------------------------------------------
+// Return the names of the configurations (excluding the default configuration),
+// and note if there is a default configuration.
+QStringList configStore::getConfigNames( PersistanceManager* pm, const QString& configFile, const QString& rootName,
+                                         bool& hasDefault )
+{
+    if( !isDirectoryStore( configFile ) )
+    {
+        return pm->getConfigNames( configFile, rootName, hasDefault );
+    }
+
+    hasDefault = false;
+    QStringList names;
+    const indexList index = readIndex( pm, configFile, rootName );
+    for( int i = 0; i < index.count(); i++ )
+    {
+        if( index[i].second == PersistanceManager::defaultName )
+        {
+            hasDefault = true;
+        }
+        else
+        {
+            names.append( index[i].second );
+        }
+    }
+
+    return names;
+}
+
+QStringList configStore::getConfigNames( PersistanceManager* pm, const QString& configFile, const QString& rootName )
+{
+    if( !isDirectoryStore( configFile ) )
+    {
+        return pm->getConfigNames( configFile, rootName );
+    }
+
+    bool hasDefault;
+    return getConfigNames( pm, configFile, rootName, hasDefault );
+}
+
+//------------------------------------------------------------------------------
+// Return true if a named configuration is present
+bool configStore::isConfigurationPresent( PersistanceManager* pm, const QString& configFile, const QString& rootName,
+                                          const QString& configName )
+{
+    if( !isDirectoryStore( configFile ) )
+    {
+        return pm->isConfigurationPresent( configFile, rootName, configName );
+    }
+
+    return QFile::exists( configurationFile( configFile, configName ) );
+}
+
+//------------------------------------------------------------------------------
+// Read a directory store index.
+// If there is no index, but there are configuration files, the index is rebuilt from them.
+configStore::indexList configStore::readIndex( PersistanceManager* pm, const QString& configFile, const QString& rootName )
+{
+    indexList index;
+    const QDir dir( configFile );
+
+    QFile file( dir.filePath( INDEX_FILE_NAME ) );
+    if( file.open( QIODevice::ReadOnly | QIODevice::Text ) )
+    {
+        QTextStream stream( &file );
+        while( !stream.atEnd() )
+        {
+            const QString line = stream.readLine();
+            const int tab = line.indexOf( '\t' );
+            if( tab > 0 )
+            {
+                index.append( qMakePair( line.left( tab ), line.mid( tab + 1 ) ) );
+            }
+        }
+        file.close();
+        return index;
+    }
+
+    // No index. Rebuild it.
+    const QStringList files = dir.entryList( QStringList( "*.xml" ), QDir::Files, QDir::Name );
+    if( files.isEmpty() )
+    {
+        return index;
+    }
+
+    for( int i = 0; i < files.count(); i++ )
+    {
+        bool hasDefault = false;
+        const QStringList names = pm->getConfigNames( dir.filePath( files[i] ), rootName, hasDefault );
+        for( int j = 0; j < names.count(); j++ )
+        {
+            index.append( qMakePair( files[i], names[j] ) );
+        }
+        if( hasDefault )
+        {
+            index.append( qMakePair( files[i], PersistanceManager::defaultName ) );
+        }
+    }
+    writeIndex( configFile, index );
+
+    return index;
+}
+
+//------------------------------------------------------------------------------
+// Write a directory store index (atomically, so readers never see a partly written index)
+bool configStore::writeIndex( const QString& configFile, const indexList& index )
+{
+    QSaveFile file( QDir( configFile ).filePath( INDEX_FILE_NAME ) );
+    if( !file.open( QIODevice::WriteOnly | QIODevice::Text ) )
+    {
+        DEBUG << file.fileName() << " file open (write) failed";
+        return false;
+    }
+
+    QTextStream stream( &file );
+    for( int i = 0; i < index.count(); i++ )
+    {
+        stream << index[i].first << '\t' << index[i].second << '\n';
+    }
+    stream.flush();
+
+    return file.commit();
+}
+
+// end
@@ -0,0 +1,78 @@
+/*  configStore.h
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+/*
+ * DESCRIPTION:
+ *
+ * Configuration storage.
+ *
+ * By default all named configurations are held in a single configuration file
+ * (QEGuiConfig.xml), which the persistance manager reads and rewrites in full
+ * on every save. Where a configuration file name ends in ".d" (or names an
+ * existing directory), the configurations are instead held in a directory with
+ * one file per configuration and an index of configuration names. The cost of a
+ * save then depends only on the size of the configuration being saved.
+ *
+ * Each configuration file in a directory store is an ordinary configuration file
+ * holding a single configuration, so the persistance manager is used unchanged to
+ * read and write it. The index (index.txt) holds a line per configuration with the
+ * file name and configuration name separated by a tab. If the index is missing it is
+ * rebuilt from the configuration files.
+ *
+ * All configuration file access by the application goes through this class.
+ */
+
+#ifndef QEGUI_CONFIG_STORE_H
+#define QEGUI_CONFIG_STORE_H
+
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+
+class PersistanceManager;
+
+class configStore
+{
+public:
+    // Return true if the configuration file is a directory store (one file per configuration)
+    static bool isDirectoryStore( const QString& configFile );
+
+    // Return the file holding a named configuration. For a single file store this is the configuration file itself.
+    static QString configurationFile( const QString& configFile, const QString& configName );
+
+    // Record that a named configuration has been saved to its file (updates a directory store index if required)
+    static void noteSaved( PersistanceManager* pm, const QString& configFile, const QString& rootName, const QString& configName );
+
+    // Equivalents of the PersistanceManager methods of the same names
+    static void save( PersistanceManager* pm, const QString& configFile, const QString& rootName,
+                      const QString& configName, const bool warnUser );
+    static void restore( PersistanceManager* pm, const QString& configFile, const QString& rootName,
+                         const QString& configName );
+    static void deleteConfigs( PersistanceManager* pm, const QString& configFile, const QString& rootName,
+                               const QStringList& names, const bool warnUser );
+    static QStringList getConfigNames( PersistanceManager* pm, const QString& configFile, const QString& rootName,
+                                       bool& hasDefault );
+    static QStringList getConfigNames( PersistanceManager* pm, const QString& configFile, const QString& rootName );
+    static bool isConfigurationPresent( PersistanceManager* pm, const QString& configFile, const QString& rootName,
+                                        const QString& configName );
+
+private:
+    // Directory store index: file name for each configuration name
+    typedef QList<QPair<QString, QString> > indexList;
+
+    static indexList readIndex( PersistanceManager* pm, const QString& configFile, const QString& rootName );
+    static bool writeIndex( const QString& configFile, const indexList& index );
+};
+
+#endif // QEGUI_CONFIG_STORE_H
@@ -0,0 +1,122 @@
+/*  formCache.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+// Manage an in-process cache of resolved .ui file names. Refer to formCache.h for details.
+
+#include "formCache.h"
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QStringList>
+#include <ContainerProfile.h>
+#include <QEWidget.h>
+
+#define DEBUG qDebug() << "formCache" << __LINE__ << __FUNCTION__ << "  "
+
+//------------------------------------------------------------------------------
+// Construction
+formCache::formCache( QObject* parent ) : QObject( parent )
+{
+    hits = 0;
+    misses = 0;
+    invalidations = 0;
+}
+
+//------------------------------------------------------------------------------
+// Destruction
+formCache::~formCache()
+{
+}
+
+//------------------------------------------------------------------------------
+// Resolve a .ui file name using the given profile (path list and parent path).
+// The result is remembered for the same name and search context, and returned
+// on subsequent calls without any file system access.
+//
+QString formCache::resolve( const QString& fileName, ContainerProfile* profile )
+{
+    const QString key = ( QStringList()
+                          << fileName
+                          << profile->getParentPath()
+                          << profile->getPathList().join( "\n" )
+                          << profile->getEnvPathList().join( "\n" ) ).join( "\t" );
+
+    QHash<QString, QString>::const_iterator it = resolvedNames.constFind( key );
+    if( it != resolvedNames.constEnd() )
+    {
+        hits++;
+        return it.value();
+    }
+
+    misses++;
+
+    // Not resolved previously. Search for it. (A file not found is not remembered)
+    QFile* uiFile = QEWidget::findQEFile( fileName, profile );
+    if( !uiFile )
+    {
+        return QString();
+    }
+
+    const QString resolved = QFileInfo( uiFile->fileName() ).absoluteFilePath();
+    delete uiFile;
+
+    resolvedNames.insert( key, resolved );
+    return resolved;
+}
+
+//------------------------------------------------------------------------------
+// Discard any cached resolution to a file, so the path list is searched afresh
+// the next time it is opened (a file may have been added earlier in the path list).
+void formCache::invalidate( const QString& fileName )
+{
+    const QString absolutePath = QFileInfo( fileName ).absoluteFilePath();
+
+    QHash<QString, QString>::iterator it = resolvedNames.begin();
+    while( it != resolvedNames.end() )
+    {
+        if( it.value() == absolutePath )
+        {
+            it = resolvedNames.erase( it );
+            invalidations++;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// Discard all cached resolutions
+void formCache::invalidateAll()
+{
+    invalidations += resolvedNames.count();
+    resolvedNames.clear();
+}
+
+//------------------------------------------------------------------------------
+// Provide a statistics summary string
+QString formCache::getStatistics() const
+{
+    const int lookups = hits + misses;
+    const double hitRate = lookups ? ( 100.0 * hits ) / lookups : 0.0;
+
+    return QString( "Form name cache: %1 entries, %2 hits, %3 misses (%4% hit rate), %5 invalidations." )
+               .arg( resolvedNames.count() )
+               .arg( hits )
+               .arg( misses )
+               .arg( hitRate, 0, 'f', 1 )
+               .arg( invalidations );
+}
+
+// end
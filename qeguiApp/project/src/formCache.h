@@ -0,0 +1,73 @@
+/*  formCache.h
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+/*
+ * DESCRIPTION:
+ *
+ * This class maintains an in-process cache of resolved .ui file names.
+ *
+ * Each time a GUI is launched, MainWindow::launchGui() resolves the .ui file name
+ * against the published profile (path list and parent path) to check if the GUI
+ * is already open. The cache remembers the result, so a repeat launch does not
+ * search the path list (a file system access per directory) again. A remembered
+ * name is not checked again, so a file added earlier in the path list, or removed,
+ * is not noticed until the name is discarded ('Refresh Current Form').
+ *
+ * This is a cache of names only. The QEForm is still given the name as requested,
+ * and reads and parses the .ui file itself each time a GUI is created.
+ *
+ * Hit and miss counters are kept so the effectiveness of the cache can be
+ * confirmed from the 'About' dialog.
+ */
+
+#ifndef QEGUI_FORM_CACHE_H
+#define QEGUI_FORM_CACHE_H
+
+#include <QObject>
+#include <QHash>
+#include <QString>
+
+class ContainerProfile;
+
+// Class managing the cache of resolved .ui file names
+class formCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit formCache( QObject* parent = 0 );
+    ~formCache();
+
+    // Resolve a .ui file name using the given profile and return the absolute
+    // file name of the file found. Returns an empty string if the file can't be found.
+    QString resolve( const QString& fileName, ContainerProfile* profile );
+
+    void invalidate( const QString& fileName );         // Discard any cached resolution to a file
+    void invalidateAll();                               // Discard all cached resolutions
+
+    // Cache statistics
+    int getEntryCount() const { return resolvedNames.count(); }
+    int getHits() const { return hits; }
+    int getMisses() const { return misses; }
+    int getInvalidations() const { return invalidations; }
+    QString getStatistics() const;                      // Summary suitable for presenting to the user
+
+private:
+    QHash<QString, QString> resolvedNames;              // Resolved absolute file names, keyed by name and search context
+
+    int hits;                                           // Number of resolutions satisfied by a cached name
+    int misses;                                         // Number of resolutions that required the path list to be searched
+    int invalidations;                                  // Number of cached names discarded
+};
+
+#endif // QEGUI_FORM_CACHE_H
@@ -0,0 +1,253 @@
+/*  formIndex.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+// Maintain an application wide index of the open GUIs. Refer to formIndex.h for details.
+
+#include "formIndex.h"
+#include <QDebug>
+#include <QFileInfo>
+#include <QStringList>
+#include <MainWindow.h>
+
+#define DEBUG qDebug() << "formIndex" << __LINE__ << __FUNCTION__ << "  "
+
+// Limit on the number of file names for which the canonical path is remembered.
+// They are cheap to re-create, so when the limit is reached they are simply all discarded.
+#define MAX_CANONICAL_PATHS  1000
+
+//------------------------------------------------------------------------------
+// Construction
+formIndex::formIndex( QObject* parent ) : QObject( parent )
+{
+    lookups = 0;
+    formHits = 0;
+    titleHits = 0;
+}
+
+formIndex::~formIndex()
+{
+}
+
+//------------------------------------------------------------------------------
+// Return the index key of a GUI - the canonical path of the .ui file and the normalised macro substitutions
+QString formIndex::formKey( const QString& fileName, const QString& macroSubstitutions )
+{
+    QHash<QString, QString>::const_iterator it = canonicalPaths.constFind( fileName );
+    QString canonicalPath;
+    if( it != canonicalPaths.constEnd() )
+    {
+        canonicalPath = it.value();
+    }
+    else
+    {
+        canonicalPath = QFileInfo( fileName ).canonicalFilePath();
+        if( canonicalPath.isEmpty() )
+        {
+            canonicalPath = fileName;
+        }
+        if( canonicalPaths.count() >= MAX_CANONICAL_PATHS )
+        {
+            canonicalPaths.clear();
+        }
+        canonicalPaths.insert( fileName, canonicalPath );
+    }
+
+    const QHash<QString, QString> substitutions = parseSubstitutions( macroSubstitutions );
+    QStringList macros;
+    QHash<QString, QString>::const_iterator sit = substitutions.constBegin();
+    while( sit != substitutions.constEnd() )
+    {
+        macros.append( QString( "%1=%2" ).arg( sit.key() ).arg( sit.value() ) );
+        ++sit;
+    }
+    macros.sort();
+
+    return QString( "%1\t%2" ).arg( canonicalPath ).arg( macros.join( "," ) );
+}
+
+//------------------------------------------------------------------------------
+// Forget the canonical paths remembered. Any .ui file, or a symbolic link to one,
+// may have changed, so the path of every file name is found afresh when next used.
+void formIndex::invalidatePaths()
+{
+    canonicalPaths.clear();
+}
+
+//------------------------------------------------------------------------------
+// Split macro substitutions in the form "A=1,B=2" into a name/value hash.
+// Where a name appears more than once the first substitution is used.
+//
+QHash<QString, QString> formIndex::parseSubstitutions( const QString& substitutions )
+{
+    QHash<QString, QString> result;
+
+    const QStringList parts = substitutions.split( "," );
+    for( int i = 0; i < parts.count(); i++ )
+    {
+        const int equals = parts[i].indexOf( '=' );
+        if( equals <= 0 )
+        {
+            continue;
+        }
+
+        const QString name = parts[i].left( equals ).trimmed();
+        QString value = parts[i].mid( equals + 1 ).trimmed();
+
+        // Values may be quoted
+        if( value.length() >= 2 &&
+            ( ( value.startsWith( '"' ) && value.endsWith( '"' ) ) ||
+              ( value.startsWith( '\'' ) && value.endsWith( '\'' ) ) ) )
+        {
+            value = value.mid( 1, value.length() - 2 );
+        }
+
+        if( !name.isEmpty() && !result.contains( name ) )
+        {
+            result.insert( name, value );
+        }
+    }
+
+    return result;
+}
+
+//------------------------------------------------------------------------------
+// Index a GUI in a main window. If the GUI is already indexed, it has moved.
+void formIndex::addForm( QEForm* form, MainWindow* mw )
+{
+    removeForm( form );
+
+    formEntry entry;
+    entry.key = formKey( form->getFullFileName(), form->getMacroSubstitutions() );
+    entry.mainWindow = mw;
+    forms.insert( form, entry );
+    formsByKey.insert( entry.key, form );
+}
+
+//------------------------------------------------------------------------------
+// Remove a GUI from the index
+void formIndex::removeForm( QEForm* form )
+{
+    QHash<QEForm*, formEntry>::iterator it = forms.find( form );
+    if( it == forms.end() )
+    {
+        return;
+    }
+
+    formsByKey.remove( it.value().key, form );
+    forms.erase( it );
+}
+
+//------------------------------------------------------------------------------
+// Index a main window by title, and follow any title changes
+void formIndex::addMainWindow( MainWindow* mw )
+{
+    if( titles.contains( mw ) )
+    {
+        return;
+    }
+
+    const QString title = mw->windowTitle();
+    titles.insert( mw, title );
+    mainWindowsByTitle.insert( title, mw );
+    QObject::connect( mw, SIGNAL( windowTitleChanged( const QString& ) ), this, SLOT( titleChanged( const QString& ) ) );
+}
+
+//------------------------------------------------------------------------------
+// Remove a main window, and any GUIs it contains, from the index
+void formIndex::removeMainWindow( MainWindow* mw )
+{
+    QHash<MainWindow*, QString>::iterator it = titles.find( mw );
+    if( it != titles.end() )
+    {
+        mainWindowsByTitle.remove( it.value(), mw );
+        titles.erase( it );
+        QObject::disconnect( mw, SIGNAL( windowTitleChanged( const QString& ) ), this, SLOT( titleChanged( const QString& ) ) );
+    }
+
+    QHash<QEForm*, formEntry>::iterator fit = forms.begin();
+    while( fit != forms.end() )
+    {
+        if( fit.value().mainWindow == mw )
+        {
+            formsByKey.remove( fit.value().key, fit.key() );
+            fit = forms.erase( fit );
+        }
+        else
+        {
+            ++fit;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// A main window title has changed. Re-index it.
+void formIndex::titleChanged( const QString& title )
+{
+    MainWindow* mw = static_cast<MainWindow*>( sender() );
+    QHash<MainWindow*, QString>::iterator it = titles.find( mw );
+    if( it == titles.end() )
+    {
+        return;
+    }
+
+    mainWindowsByTitle.remove( it.value(), mw );
+    it.value() = title;
+    mainWindowsByTitle.insert( title, mw );
+}
+
+//------------------------------------------------------------------------------
+// Find an open GUI given an absolute .ui file name and macro substitutions
+QEForm* formIndex::findForm( const QString& fileName, const QString& macroSubstitutions, MainWindow** mw )
+{
+    lookups++;
+
+    QMultiHash<QString, QEForm*>::const_iterator it = formsByKey.constFind( formKey( fileName, macroSubstitutions ) );
+    if( it == formsByKey.constEnd() )
+    {
+        return NULL;
+    }
+
+    formHits++;
+    QEForm* form = it.value();
+    if( mw )
+    {
+        *mw = forms.value( form ).mainWindow;
+    }
+    return form;
+}
+
+//------------------------------------------------------------------------------
+// Find a main window given its title
+MainWindow* formIndex::findMainWindow( const QString& title )
+{
+    MainWindow* mw = mainWindowsByTitle.value( title, NULL );
+    if( mw )
+    {
+        titleHits++;
+    }
+    return mw;
+}
+
+//------------------------------------------------------------------------------
+// Summary suitable for presenting to the user
+QString formIndex::getStatistics() const
+{
+    return QString( "Open GUI index: %1 GUIs in %2 main windows, %3 lookups, %4 found open, %5 found by window title." )
+               .arg( forms.count() )
+               .arg( titles.count() )
+               .arg( lookups )
+               .arg( formHits )
+               .arg( titleHits );
+}
+
+// end
@@ -0,0 +1,104 @@
+/*  formIndex.h
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+/*
+ * DESCRIPTION:
+ *
+ * This class maintains an application wide index of the open GUIs.
+ *
+ * When a GUI is launched (typically by a QEPushButton) and the same .ui file with
+ * the same macro substitutions is already open, the existing GUI is raised rather
+ * than a new one opened. Failing that, a main window with a title matching the
+ * title requested is raised.
+ *
+ * To avoid searching every GUI in every main window on each launch, GUIs are
+ * indexed by the canonical path of their .ui file and their normalised macro
+ * substitutions (trimmed, first definition of each macro only, in name order),
+ * and main windows are indexed by their title. The index is updated as GUIs are
+ * added to and removed from main windows, and as main windows are added, removed
+ * and re-titled.
+ *
+ * The canonical path of each .ui file name is remembered. As files (or symbolic
+ * links to them) may have changed, the remembered paths are forgotten whenever a
+ * GUI is to be read afresh (see invalidatePaths()).
+ */
+
+#ifndef QEGUI_FORM_INDEX_H
+#define QEGUI_FORM_INDEX_H
+
+#include <QObject>
+#include <QHash>
+#include <QMultiHash>
+#include <QString>
+
+class QEForm;
+class MainWindow;
+
+// Class indexing the open GUIs and main windows
+class formIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit formIndex( QObject* parent = 0 );
+    ~formIndex();
+
+    void addForm( QEForm* form, MainWindow* mw );       // Index a GUI in a main window
+    void removeForm( QEForm* form );                    // Remove a GUI from the index
+
+    void addMainWindow( MainWindow* mw );               // Index a main window by title
+    void removeMainWindow( MainWindow* mw );            // Remove a main window (and any of its GUIs) from the index
+
+    // Find an open GUI given an absolute .ui file name and macro substitutions.
+    // Returns NULL if none. If found, the main window containing the GUI is also returned.
+    QEForm* findForm( const QString& fileName, const QString& macroSubstitutions, MainWindow** mw );
+
+    MainWindow* findMainWindow( const QString& title );   // Find a main window given its title. Returns NULL if none.
+
+    QList<QEForm*> getForms() const { return forms.keys(); }   // Return all open GUIs
+
+    QString getStatistics() const;                      // Summary suitable for presenting to the user
+
+    // Index key of a GUI - the canonical path of the .ui file and the normalised macro substitutions
+    QString formKey( const QString& fileName, const QString& macroSubstitutions );
+
+    void invalidatePaths();                             // Forget the canonical paths remembered (files or links may have changed)
+
+private:
+
+    class formEntry
+    {
+    public:
+        QString key;                                    // Index key (canonical path and normalised macro substitutions)
+        MainWindow* mainWindow;                         // Main window containing the GUI
+    };
+
+    QHash<QEForm*, formEntry> forms;                    // All indexed GUIs
+    QMultiHash<QString, QEForm*> formsByKey;            // GUIs by key. (There may be more than one with the same key)
+    QHash<MainWindow*, QString> titles;                 // Indexed main windows, and the title each is indexed by
+    QMultiHash<QString, MainWindow*> mainWindowsByTitle;    // Main windows by title
+
+    QHash<QString, QString> canonicalPaths;             // Canonical path of each .ui file name seen
+
+    // Split macro substitutions in the form "A=1,B=2" into a name/value hash
+    static QHash<QString, QString> parseSubstitutions( const QString& substitutions );
+
+    int lookups;                                        // Number of GUI lookups
+    int formHits;                                       // Number of lookups that found an open GUI
+    int titleHits;                                      // Number of lookups that found a main window by title
+
+private slots:
+    void titleChanged( const QString& title );
+};
+
+#endif // QEGUI_FORM_INDEX_H
@@ -0,0 +1,151 @@
+/*  formProfileDialog.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+/*
+ * This class presents the costs accumulated by the form profiler
+ */
+
+#include "formProfileDialog.h"
+#include "ui_formProfileDialog.h"
+#include <QHeaderView>
+#include <QTableWidget>
+#include <QEGui.h>
+
+// Number of widgets listed
+#define MAX_WIDGETS  200
+
+// Interval between refreshes of the tables (mS)
+#define REFRESH_INTERVAL  1000
+
+// Table columns
+enum columns { COL_NAME, COL_CLASS, COL_FORM, COL_TOTAL, COL_PAINT, COL_RESIZE, COL_LAYOUT, COL_UPDATE, COL_EVENTS, COLUMNS };
+
+//------------------------------------------------------------------------------
+// Present the dialog to the user
+formProfileDialog::formProfileDialog( QEGui* appIn, QWidget* parent ) :
+    QEDialog( parent ),
+    ui( new Ui::formProfileDialog )
+{
+    ui->setupUi( this );
+    app = appIn;
+
+    setUpTable( ui->widgetsTableWidget, "Widget", "Class" );
+    setUpTable( ui->formsTableWidget, "Form", "File" );
+    ui->formsTableWidget->setColumnHidden( COL_FORM, true );
+
+    formProfiler* profiler = app->getFormProfiler();
+    ui->profileCheckBox->setChecked( profiler->isEnabled() );
+    ui->heatMapCheckBox->setChecked( profiler->isHeatMapVisible() );
+
+    refreshTimer.setInterval( REFRESH_INTERVAL );
+    QObject::connect( &refreshTimer, SIGNAL( timeout() ), this, SLOT( refresh() ) );
+    refreshTimer.start();
+    refresh();
+}
+
+//------------------------------------------------------------------------------
+// Remove the dialog
+formProfileDialog::~formProfileDialog()
+{
+    delete ui;
+}
+
+//------------------------------------------------------------------------------
+// Set up the columns of a table
+void formProfileDialog::setUpTable( QTableWidget* table, const QString& nameTitle, const QString& classTitle )
+{
+    QStringList headings;
+    headings << nameTitle << classTitle << "Form" << "Total mS"
+             << QString( "%1 mS" ).arg( formProfiler::categoryName( formProfiler::COST_PAINT ) )
+             << QString( "%1 mS" ).arg( formProfiler::categoryName( formProfiler::COST_RESIZE ) )
+             << QString( "%1 mS" ).arg( formProfiler::categoryName( formProfiler::COST_LAYOUT ) )
+             << QString( "%1 mS" ).arg( formProfiler::categoryName( formProfiler::COST_UPDATE ) )
+             << "Events";
+    table->setColumnCount( COLUMNS );
+    table->setHorizontalHeaderLabels( headings );
+    table->verticalHeader()->setVisible( false );
+    table->horizontalHeader()->setStretchLastSection( true );
+}
+
+//------------------------------------------------------------------------------
+// Fill a table with costs, most expensive first
+static void fillTable( QTableWidget* table, const QList<formProfiler::costEntry>& costs )
+{
+    table->setRowCount( costs.count() );
+    for( int row = 0; row < costs.count(); row++ )
+    {
+        const formProfiler::costEntry& entry = costs[row];
+        qint64 events = 0;
+        for( int i = 0; i < formProfiler::COST_CATEGORIES; i++ )
+        {
+            events += entry.count[i];
+        }
+
+        QStringList cells;
+        cells << entry.name << entry.className << entry.formTitle
+              << QString::number( entry.total, 'f', 1 )
+              << QString::number( entry.time[formProfiler::COST_PAINT], 'f', 1 )
+              << QString::number( entry.time[formProfiler::COST_RESIZE], 'f', 1 )
+              << QString::number( entry.time[formProfiler::COST_LAYOUT], 'f', 1 )
+              << QString::number( entry.time[formProfiler::COST_UPDATE], 'f', 1 )
+              << QString::number( events );
+
+        for( int col = 0; col < cells.count(); col++ )
+        {
+            QTableWidgetItem* item = table->item( row, col );
+            if( !item )
+            {
+                item = new QTableWidgetItem;
+                if( col >= COL_TOTAL )
+                {
+                    item->setTextAlignment( Qt::AlignRight | Qt::AlignVCenter );
+                }
+                table->setItem( row, col, item );
+            }
+            item->setText( cells[col] );
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// Present the current costs
+void formProfileDialog::refresh()
+{
+    formProfiler* profiler = app->getFormProfiler();
+    fillTable( ui->widgetsTableWidget, profiler->getWidgetCosts( MAX_WIDGETS ) );
+    fillTable( ui->formsTableWidget, profiler->getFormCosts() );
+}
+
+//------------------------------------------------------------------------------
+// The user has turned profiling on or off
+void formProfileDialog::on_profileCheckBox_toggled( bool checked )
+{
+    app->setFormProfiling( checked );
+}
+
+//------------------------------------------------------------------------------
+// The user has shown or hidden the heat map
+void formProfileDialog::on_heatMapCheckBox_toggled( bool checked )
+{
+    app->getFormProfiler()->setHeatMapVisible( checked );
+}
+
+//------------------------------------------------------------------------------
+// The user pressed "Reset"
+void formProfileDialog::on_resetPushButton_clicked()
+{
+    app->getFormProfiler()->reset();
+    refresh();
+}
+
+// end
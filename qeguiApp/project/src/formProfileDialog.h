@@ -0,0 +1,57 @@
+/*  formProfileDialog.h
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+/* Description:
+ *
+ * Presents the costs accumulated by the form profiler: the most expensive
+ * widgets, and the cost of each GUI, most expensive first. The tables are
+ * refreshed every second while the dialog is open. Profiling and the heat
+ * map overlay may be turned on and off from the dialog.
+ */
+
+#ifndef QEGUI_FORM_PROFILE_DIALOG_H
+#define QEGUI_FORM_PROFILE_DIALOG_H
+
+#include <QEDialog.h>
+#include <QTimer>
+
+class QEGui;
+class QTableWidget;
+
+namespace Ui {
+    class formProfileDialog;
+}
+
+class formProfileDialog : public QEDialog
+{
+    Q_OBJECT
+
+public:
+    explicit formProfileDialog( QEGui* appIn, QWidget* parent = 0 );
+    ~formProfileDialog();
+
+private:
+    Ui::formProfileDialog* ui;
+    QEGui* app;
+    QTimer refreshTimer;                        // Refreshes the tables while the dialog is open
+
+    void setUpTable( QTableWidget* table, const QString& nameTitle, const QString& classTitle );
+
+private slots:
+    void refresh();                             // Present the current costs
+    void on_profileCheckBox_toggled( bool checked );
+    void on_heatMapCheckBox_toggled( bool checked );
+    void on_resetPushButton_clicked();
+};
+
+#endif // QEGUI_FORM_PROFILE_DIALOG_H
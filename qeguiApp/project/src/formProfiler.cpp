@@ -0,0 +1,586 @@
+/*  formProfiler.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+// Profile the cost of the widgets of each GUI. Refer to formProfiler.h for details.
+
+#include "formProfiler.h"
+#include <algorithm>
+#include <QChildEvent>
+#include <QDebug>
+#include <QEvent>
+#include <QPainter>
+#include <QPair>
+#include <QEForm.h>
+
+#define DEBUG qDebug() << "formProfiler" << __LINE__ << __FUNCTION__ << "  "
+
+// Interval between heat map updates (mS)
+#define HEAT_MAP_INTERVAL  1000
+
+// Number of GUIs listed in the statistics
+#define REPORT_FORMS       10
+
+//==============================================================================
+// Heat map overlaid on a GUI.
+// Each profiled widget is shaded in proportion to its total cost relative to the
+// most expensive widget in the GUI. The more expensive widgets are also labelled
+// with their cost.
+class formHeatMap : public QWidget
+{
+public:
+    formHeatMap( formProfiler* profilerIn, QEForm* formIn ) : QWidget( formIn )
+    {
+        profiler = profilerIn;
+        form = formIn;
+        setAttribute( Qt::WA_TransparentForMouseEvents );
+        setGeometry( form->rect() );
+    }
+
+protected:
+    void paintEvent( QPaintEvent* );
+
+private:
+    formProfiler* profiler;
+    QEForm* form;
+};
+
+void formHeatMap::paintEvent( QPaintEvent* )
+{
+    // Gather the total cost of each visible widget in the GUI
+    QList<QPair<QWidget*, qint64> > costs;
+    qint64 maxCost = 0;
+    QHash<QObject*, formProfiler::widgetCost*>::const_iterator it = profiler->widgets.constBegin();
+    while( it != profiler->widgets.constEnd() )
+    {
+        const formProfiler::widgetCost* cost = it.value();
+        QWidget* widget = cost->widget;
+        if( cost->form == form && widget && widget != form && widget->isVisibleTo( form ) )
+        {
+            qint64 total = 0;
+            for( int i = 0; i < formProfiler::COST_CATEGORIES; i++ )
+            {
+                total += cost->nsecs[i];
+            }
+            if( total > 0 )
+            {
+                costs.append( QPair<QWidget*, qint64>( widget, total ) );
+                maxCost = qMax( maxCost, total );
+            }
+        }
+        ++it;
+    }
+
+    if( !maxCost )
+    {
+        return;
+    }
+
+    QPainter painter( this );
+    for( int i = 0; i < costs.count(); i++ )
+    {
+        QWidget* widget = costs[i].first;
+        const double heat = double( costs[i].second ) / maxCost;
+        const QRect area( widget->mapTo( form, QPoint( 0, 0 ) ), widget->size() );
+
+        painter.fillRect( area, QColor( 255, 0, 0, int( 20 + 160 * heat ) ) );
+        if( heat >= 0.1 )
+        {
+            painter.setPen( Qt::black );
+            painter.drawText( area.adjusted( 2, 2, -2, -2 ), Qt::AlignLeft | Qt::AlignTop,
+                              QString( "%1 mS" ).arg( costs[i].second / 1000000.0, 0, 'f', 1 ) );
+        }
+    }
+}
+
+//==============================================================================
+// Construction
+formProfiler::formProfiler( QObject* parent ) : QObject( parent )
+{
+    enabled = false;
+    heatMapVisible = false;
+    addingHeatMap = false;
+    nestedNsecs = 0;
+
+    heatMapTimer.setInterval( HEAT_MAP_INTERVAL );
+    QObject::connect( &heatMapTimer, SIGNAL( timeout() ), this, SLOT( updateHeatMaps() ) );
+}
+
+formProfiler::~formProfiler()
+{
+    qDeleteAll( widgets );
+}
+
+//------------------------------------------------------------------------------
+// Return the name of a cost category
+QString formProfiler::categoryName( const int category )
+{
+    switch( category )
+    {
+        case COST_PAINT:  return "Paint";
+        case COST_RESIZE: return "Resize";
+        case COST_LAYOUT: return "Layout";
+        case COST_UPDATE: return "PV update";
+        default:          return "";
+    }
+}
+
+//------------------------------------------------------------------------------
+// Start or stop profiling. When starting, the open GUIs are registered.
+// Costs accumulated so far are kept. (Use reset() to discard them)
+void formProfiler::setEnabled( const bool enabledIn, const QList<QEForm*>& openForms )
+{
+    if( enabledIn == enabled )
+    {
+        return;
+    }
+    enabled = enabledIn;
+
+    if( enabled )
+    {
+        for( int i = 0; i < openForms.count(); i++ )
+        {
+            addForm( openForms[i] );
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// Register the widgets of a GUI, if profiling
+void formProfiler::addForm( QEForm* form )
+{
+    if( !enabled || !form )
+    {
+        return;
+    }
+
+    if( !forms.contains( form ) )
+    {
+        formEntry entry;
+        entry.form = form;
+        entry.title = form->getQEGuiTitle();
+        entry.fileName = form->getFullFileName();
+        for( int i = 0; i < COST_CATEGORIES; i++ )
+        {
+            entry.nsecs[i] = 0;
+            entry.count[i] = 0;
+        }
+        forms.insert( form, entry );
+        QObject::connect( form, SIGNAL( destroyed( QObject* ) ), this, SLOT( formDestroyed( QObject* ) ) );
+    }
+
+    addWidget( form, form );
+    QList<QWidget*> children = form->findChildren<QWidget*>();
+    for( int i = 0; i < children.count(); i++ )
+    {
+        addWidget( children[i], form );
+    }
+
+    if( heatMapVisible )
+    {
+        addHeatMap( forms[form] );
+    }
+}
+
+//------------------------------------------------------------------------------
+// Register a widget of a GUI
+void formProfiler::addWidget( QWidget* widget, QEForm* form )
+{
+    QHash<QObject*, widgetCost*>::iterator it = widgets.find( widget );
+    if( it != widgets.end() )
+    {
+        // Already registered, unless this is a new widget at the address of one deleted
+        if( it.value()->widget )
+        {
+            return;
+        }
+        delete it.value();
+        widgets.erase( it );
+    }
+
+    // Don't profile the heat maps
+    if( dynamic_cast<formHeatMap*>( widget ) )
+    {
+        return;
+    }
+
+    widgetCost* cost = new widgetCost;
+    cost->widget = widget;
+    cost->form = form;
+    for( int i = 0; i < COST_CATEGORIES; i++ )
+    {
+        cost->nsecs[i] = 0;
+        cost->count[i] = 0;
+    }
+    widgets.insert( widget, cost );
+}
+
+//------------------------------------------------------------------------------
+// Discard the costs accumulated so far
+void formProfiler::reset()
+{
+    QHash<QObject*, widgetCost*>::iterator it = widgets.begin();
+    while( it != widgets.end() )
+    {
+        if( it.value()->widget )
+        {
+            for( int i = 0; i < COST_CATEGORIES; i++ )
+            {
+                it.value()->nsecs[i] = 0;
+                it.value()->count[i] = 0;
+            }
+            ++it;
+        }
+        else
+        {
+            delete it.value();
+            it = widgets.erase( it );
+        }
+    }
+
+    QHash<QEForm*, formEntry>::iterator fit = forms.begin();
+    while( fit != forms.end() )
+    {
+        for( int i = 0; i < COST_CATEGORIES; i++ )
+        {
+            fit.value().nsecs[i] = 0;
+            fit.value().count[i] = 0;
+        }
+        ++fit;
+    }
+    closedForms.clear();
+
+    updateHeatMaps();
+}
+
+//------------------------------------------------------------------------------
+// Return the cost category of an event for a registered widget, or -1 if the event is not profiled.
+// Widgets added to a registered widget are registered here too.
+int formProfiler::profileEvent( QObject* receiver, QEvent* event )
+{
+    int category;
+    switch( event->type() )
+    {
+        case QEvent::Paint:         category = COST_PAINT;  break;
+        case QEvent::Resize:        category = COST_RESIZE; break;
+        case QEvent::LayoutRequest: category = COST_LAYOUT; break;
+        case QEvent::MetaCall:      category = COST_UPDATE; break;
+
+        case QEvent::ChildAdded:
+            {
+                QObject* child = static_cast<QChildEvent*>( event )->child();
+                QHash<QObject*, widgetCost*>::const_iterator it = widgets.constFind( receiver );
+                if( !addingHeatMap && child->isWidgetType() && it != widgets.constEnd() && it.value()->widget )
+                {
+                    addWidget( static_cast<QWidget*>( child ), it.value()->form );
+                }
+            }
+            return -1;
+
+        default:
+            return -1;
+    }
+
+    QHash<QObject*, widgetCost*>::const_iterator it = widgets.constFind( receiver );
+    if( it == widgets.constEnd() || !it.value()->widget )
+    {
+        return -1;
+    }
+    return category;
+}
+
+//------------------------------------------------------------------------------
+// Start timing a profiled event.
+// Returns the time of profiled events already nested in the enclosing event (if any), and
+// starts accumulating the time of profiled events nested in this one.
+qint64 formProfiler::startCost()
+{
+    const qint64 enclosingNested = nestedNsecs;
+    nestedNsecs = 0;
+    return enclosingNested;
+}
+
+//------------------------------------------------------------------------------
+// Add the time taken to dispatch a profiled event (nS), less the time of any profiled
+// events nested within it (already charged to the widgets that handled them).
+// The whole time is then added to the nested time of the enclosing event (if any).
+// The widget is looked up again as it may have been deleted while handling the event.
+void formProfiler::addCost( QObject* receiver, const int category, const qint64 nsecs, const qint64 enclosingNested )
+{
+    const qint64 ownNsecs = qMax( nsecs - nestedNsecs, qint64( 0 ) );
+    nestedNsecs = enclosingNested + nsecs;
+
+    QHash<QObject*, widgetCost*>::iterator it = widgets.find( receiver );
+    if( it == widgets.end() )
+    {
+        return;
+    }
+
+    it.value()->nsecs[category] += ownNsecs;
+    it.value()->count[category]++;
+}
+
+//------------------------------------------------------------------------------
+// A GUI has been closed. Fold the cost of its widgets into the GUI's totals, forget the widgets,
+// and keep the GUI's totals for reporting.
+void formProfiler::formDestroyed( QObject* object )
+{
+    // Only the pointer value is used, the object is no longer a QEForm
+    QEForm* form = static_cast<QEForm*>( object );
+    QHash<QEForm*, formEntry>::iterator fit = forms.find( form );
+
+    QHash<QObject*, widgetCost*>::iterator it = widgets.begin();
+    while( it != widgets.end() )
+    {
+        widgetCost* cost = it.value();
+        if( cost->form == form )
+        {
+            if( fit != forms.end() )
+            {
+                for( int i = 0; i < COST_CATEGORIES; i++ )
+                {
+                    fit.value().nsecs[i] += cost->nsecs[i];
+                    fit.value().count[i] += cost->count[i];
+                }
+            }
+            delete cost;
+            it = widgets.erase( it );
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    if( fit != forms.end() )
+    {
+        closedForms.append( fit.value() );
+        forms.erase( fit );
+    }
+}
+
+//------------------------------------------------------------------------------
+// Fill in a cost entry
+void formProfiler::makeEntry( const QString& name, const QString& className, const QString& formTitle,
+                              const qint64* nsecs, const qint64* count, costEntry& entry ) const
+{
+    entry.name = name;
+    entry.className = className;
+    entry.formTitle = formTitle;
+    entry.total = 0.0;
+    for( int i = 0; i < COST_CATEGORIES; i++ )
+    {
+        entry.time[i] = nsecs[i] / 1000000.0;
+        entry.count[i] = count[i];
+        entry.total += entry.time[i];
+    }
+}
+
+// Sort most expensive first
+static bool moreExpensive( const formProfiler::costEntry& a, const formProfiler::costEntry& b )
+{
+    return a.total > b.total;
+}
+
+//------------------------------------------------------------------------------
+// Return the most expensive widgets, most expensive first
+QList<formProfiler::costEntry> formProfiler::getWidgetCosts( const int limit ) const
+{
+    QList<costEntry> costs;
+    QHash<QObject*, widgetCost*>::const_iterator it = widgets.constBegin();
+    while( it != widgets.constEnd() )
+    {
+        const widgetCost* cost = it.value();
+        QWidget* widget = cost->widget;
+        if( widget )
+        {
+            const QString className = widget->metaObject()->className();
+            costEntry entry;
+            makeEntry( widget->objectName().isEmpty() ? className : widget->objectName(), className,
+                       forms.value( cost->form ).title, cost->nsecs, cost->count, entry );
+            if( entry.total > 0.0 )
+            {
+                costs.append( entry );
+            }
+        }
+        ++it;
+    }
+
+    std::sort( costs.begin(), costs.end(), moreExpensive );
+    if( limit > 0 && costs.count() > limit )
+    {
+        costs = costs.mid( 0, limit );
+    }
+    return costs;
+}
+
+//------------------------------------------------------------------------------
+// Return the cost of each GUI (including closed GUIs), most expensive first
+QList<formProfiler::costEntry> formProfiler::getFormCosts() const
+{
+    QList<costEntry> costs;
+    for( int i = 0; i < closedForms.count(); i++ )
+    {
+        const formEntry& form = closedForms[i];
+        costEntry entry;
+        makeEntry( form.title, form.fileName, QString( "%1 (closed)" ).arg( form.title ), form.nsecs, form.count, entry );
+        costs.append( entry );
+    }
+
+    // Start the open GUIs with the costs of widgets no longer present
+    QHash<QEForm*, formEntry> totals = forms;
+
+    // Add the costs of the widgets still present
+    QHash<QObject*, widgetCost*>::const_iterator it = widgets.constBegin();
+    while( it != widgets.constEnd() )
+    {
+        const widgetCost* cost = it.value();
+        QHash<QEForm*, formEntry>::iterator fit = totals.find( cost->form );
+        if( fit != totals.end() )
+        {
+            for( int i = 0; i < COST_CATEGORIES; i++ )
+            {
+                fit.value().nsecs[i] += cost->nsecs[i];
+                fit.value().count[i] += cost->count[i];
+            }
+        }
+        ++it;
+    }
+
+    QHash<QEForm*, formEntry>::const_iterator fit = totals.constBegin();
+    while( fit != totals.constEnd() )
+    {
+        const formEntry& form = fit.value();
+        costEntry entry;
+        makeEntry( form.title, form.fileName, form.title, form.nsecs, form.count, entry );
+        costs.append( entry );
+        ++fit;
+    }
+
+    std::sort( costs.begin(), costs.end(), moreExpensive );
+    return costs;
+}
+
+//------------------------------------------------------------------------------
+// Show or hide the heat map over each GUI
+void formProfiler::setHeatMapVisible( const bool visible )
+{
+    heatMapVisible = visible;
+
+    QHash<QEForm*, formEntry>::iterator it = forms.begin();
+    while( it != forms.end() )
+    {
+        formEntry& entry = it.value();
+        if( visible )
+        {
+            addHeatMap( entry );
+        }
+        else if( entry.heatMap )
+        {
+            if( entry.form )
+            {
+                entry.form->removeEventFilter( this );
+            }
+            delete entry.heatMap;
+        }
+        ++it;
+    }
+
+    if( visible )
+    {
+        heatMapTimer.start();
+    }
+    else
+    {
+        heatMapTimer.stop();
+    }
+}
+
+//------------------------------------------------------------------------------
+// Overlay a heat map on a GUI
+void formProfiler::addHeatMap( formEntry& entry )
+{
+    if( !entry.form || entry.heatMap )
+    {
+        return;
+    }
+
+    addingHeatMap = true;
+    entry.heatMap = new formHeatMap( this, entry.form );
+    addingHeatMap = false;
+
+    entry.heatMap->raise();
+    entry.heatMap->show();
+    entry.form->installEventFilter( this );
+}
+
+//------------------------------------------------------------------------------
+// Repaint the heat maps, keeping them above any widgets added since
+void formProfiler::updateHeatMaps()
+{
+    QHash<QEForm*, formEntry>::iterator it = forms.begin();
+    while( it != forms.end() )
+    {
+        if( it.value().heatMap )
+        {
+            it.value().heatMap->raise();
+            it.value().heatMap->update();
+        }
+        ++it;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Keep the heat map over each GUI the same size as the GUI
+bool formProfiler::eventFilter( QObject* watched, QEvent* event )
+{
+    if( event->type() == QEvent::Resize )
+    {
+        QHash<QEForm*, formEntry>::iterator it = forms.find( static_cast<QEForm*>( watched ) );
+        if( it != forms.end() && it.value().heatMap && it.value().form )
+        {
+            it.value().heatMap->setGeometry( it.value().form->rect() );
+        }
+    }
+    return QObject::eventFilter( watched, event );
+}
+
+//------------------------------------------------------------------------------
+// Summary suitable for presenting to the user
+QString formProfiler::getStatistics() const
+{
+    if( !enabled && forms.isEmpty() )
+    {
+        return QString( "Form cost profile: not enabled (-j option, or Tools menu)." );
+    }
+
+    const QList<costEntry> costs = getFormCosts();
+    QString statistics = QString( "Form cost profile: %1, %2 GUIs, %3 widgets profiled. Most expensive GUIs (mS):" )
+                             .arg( enabled ? "enabled" : "stopped" )
+                             .arg( forms.count() + closedForms.count() )
+                             .arg( widgets.count() );
+
+    for( int i = 0; i < costs.count() && i < REPORT_FORMS; i++ )
+    {
+        const costEntry& entry = costs[i];
+        statistics.append( QString( "\n   %1: total %2, paint %3, resize %4, layout %5, PV update %6" )
+                               .arg( entry.formTitle )
+                               .arg( entry.total, 0, 'f', 1 )
+                               .arg( entry.time[COST_PAINT], 0, 'f', 1 )
+                               .arg( entry.time[COST_RESIZE], 0, 'f', 1 )
+                               .arg( entry.time[COST_LAYOUT], 0, 'f', 1 )
+                               .arg( entry.time[COST_UPDATE], 0, 'f', 1 ) );
+    }
+    return statistics;
+}
+
+// end
@@ -0,0 +1,154 @@
+/*  formProfiler.h
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+/*
+ * DESCRIPTION:
+ *
+ * When profiling is enabled (-j option, or from the 'Form Cost Profile' dialog)
+ * this class accumulates the time spent by each widget of each GUI (QEForm)
+ * handling:
+ *    paint events
+ *    resize events
+ *    layout requests
+ *    PV updates (queued signal deliveries - QE widgets receive their PV data this way)
+ *
+ * The widgets of each GUI are registered when the GUI is created (or when profiling
+ * is enabled), and widgets added to a GUI later are registered as they are added.
+ * The application passes every event dispatched on the GUI thread through
+ * profileEvent() before and after dispatching it, so the time is measured
+ * around the widget's own handling of the event, including any event filters.
+ *
+ * Profiled events are often dispatched while handling another, for example a
+ * layout request resizing child widgets. The time of such nested profiled events
+ * is charged to the widget handling them and subtracted from the time of the
+ * event they were nested in, so each widget's time is exclusive and summing the
+ * widgets of a GUI does not count any time twice.
+ *
+ * The costs are presented, most expensive first, in the 'Form Cost Profile'
+ * dialog. A heat map may also be overlaid on each GUI, shading each widget in
+ * proportion to its cost.
+ */
+
+#ifndef QEGUI_FORM_PROFILER_H
+#define QEGUI_FORM_PROFILER_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QPointer>
+#include <QString>
+#include <QTimer>
+#include <QWidget>
+
+class QEForm;
+class QEvent;
+
+// Class profiling the cost of the widgets of each GUI
+class formProfiler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit formProfiler( QObject* parent = 0 );
+    ~formProfiler();
+
+    // Categories of cost
+    enum costCategories { COST_PAINT, COST_RESIZE, COST_LAYOUT, COST_UPDATE, COST_CATEGORIES };
+    static QString categoryName( const int category );
+
+    void setEnabled( const bool enabledIn, const QList<QEForm*>& openForms );  // Start or stop profiling. When starting, the open GUIs are registered
+    bool isEnabled() const { return enabled; }
+
+    void addForm( QEForm* form );                       // Register the widgets of a GUI (if profiling)
+    void reset();                                       // Discard the costs accumulated so far
+
+    // Return the cost category of an event for a registered widget, or -1 if the event is not profiled.
+    // Called by the application for each event dispatched on the GUI thread, before dispatching it.
+    int profileEvent( QObject* receiver, QEvent* event );
+
+    // Start timing a profiled event. Called by the application before dispatching it.
+    // Returns the time of profiled events already nested in the enclosing event, to be passed to addCost().
+    qint64 startCost();
+
+    // Add the time taken to dispatch a profiled event (nS), less any profiled events nested within it.
+    // Called by the application after dispatching it.
+    void addCost( QObject* receiver, const int category, const qint64 nsecs, const qint64 enclosingNested );
+
+    // Accumulated cost of a widget, or of a GUI
+    class costEntry
+    {
+    public:
+        QString name;                                   // Widget object name (or class if not named), or GUI title
+        QString className;                              // Widget class, or GUI .ui file
+        QString formTitle;                              // GUI title
+        double time[COST_CATEGORIES];                   // Time in each category (mS)
+        qint64 count[COST_CATEGORIES];                  // Events in each category
+        double total;                                   // Total time (mS)
+    };
+
+    QList<costEntry> getWidgetCosts( const int limit ) const;   // Return the most expensive widgets, most expensive first
+    QList<costEntry> getFormCosts() const;                      // Return the cost of each GUI, most expensive first
+
+    void setHeatMapVisible( const bool visible );       // Show or hide the heat map over each GUI
+    bool isHeatMapVisible() const { return heatMapVisible; }
+
+    QString getStatistics() const;                      // Summary suitable for presenting to the user
+
+protected:
+    bool eventFilter( QObject* watched, QEvent* event );    // Keep the heat map over each GUI the same size as the GUI
+
+private:
+    // Cost of a registered widget
+    class widgetCost
+    {
+    public:
+        QPointer<QWidget> widget;                       // The widget (guarded, so deleted widgets are recognised)
+        QEForm* form;                                   // GUI containing the widget
+        qint64 nsecs[COST_CATEGORIES];                  // Time in each category (nS)
+        qint64 count[COST_CATEGORIES];                  // Events in each category
+    };
+
+    // A registered GUI
+    class formEntry
+    {
+    public:
+        QPointer<QEForm> form;
+        QString title;                                  // GUI title
+        QString fileName;                               // GUI .ui file
+        QPointer<QWidget> heatMap;                      // Heat map overlay, if shown
+        qint64 nsecs[COST_CATEGORIES];                  // Time in each category of widgets no longer present (nS)
+        qint64 count[COST_CATEGORIES];                  // Events in each category of widgets no longer present
+    };
+
+    void addWidget( QWidget* widget, QEForm* form );    // Register a widget of a GUI
+    void addHeatMap( formEntry& entry );                // Overlay a heat map on a GUI
+    void makeEntry( const QString& name, const QString& className, const QString& formTitle,
+                    const qint64* nsecs, const qint64* count, costEntry& entry ) const;
+
+    bool enabled;                                       // Only accessed on the GUI thread
+    bool heatMapVisible;
+    bool addingHeatMap;                                 // True while creating a heat map (so it isn't registered as a widget of the GUI)
+    qint64 nestedNsecs;                                 // Time of profiled events nested in the profiled event being dispatched (nS)
+    QHash<QObject*, widgetCost*> widgets;               // Registered widgets
+    QHash<QEForm*, formEntry> forms;                    // Registered GUIs
+    QList<formEntry> closedForms;                       // Registered GUIs since closed (kept for reporting)
+    QTimer heatMapTimer;                                // Repaints the heat maps regularly
+
+    friend class formHeatMap;
+
+private slots:
+    void formDestroyed( QObject* form );
+    void updateHeatMaps();
+};
+
+#endif // QEGUI_FORM_PROFILER_H
@@ -0,0 +1,101 @@
+/*  formReusePool.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+// Hold GUIs released for reuse by a configuration restore. Refer to formReusePool.h for details.
+
+#include "formReusePool.h"
+#include <QEForm.h>
+#include <MainWindow.h>
+
+//------------------------------------------------------------------------------
+// Construction
+formReusePool::formReusePool()
+{
+    restores = 0;
+    reused = 0;
+    discarded = 0;
+}
+
+formReusePool::~formReusePool()
+{
+    clear();
+}
+
+//------------------------------------------------------------------------------
+// Add a GUI released from a main window
+void formReusePool::add( const QString& key, QEForm* form, QWidget* rGui, MainWindow* from )
+{
+    if( entries.isEmpty() )
+    {
+        restores++;
+    }
+
+    poolEntry entry;
+    entry.form = form;
+    entry.rGui = rGui;
+    entry.from = from;
+    entries.insert( key, entry );
+}
+
+//------------------------------------------------------------------------------
+// Take a GUI matching a key. Returns NULL if none.
+QEForm* formReusePool::take( const QString& key, MainWindow** from )
+{
+    QMultiHash<QString, poolEntry>::iterator it = entries.find( key );
+    while( it != entries.end() && it.key() == key )
+    {
+        poolEntry entry = it.value();
+        it = entries.erase( it );
+
+        // Skip any GUI deleted since it was released
+        if( entry.form && entry.rGui )
+        {
+            reused++;
+            if( from )
+            {
+                *from = entry.from;
+            }
+            return entry.form;
+        }
+    }
+    return NULL;
+}
+
+//------------------------------------------------------------------------------
+// Delete all GUIs not reused
+void formReusePool::clear()
+{
+    QMultiHash<QString, poolEntry>::iterator it = entries.begin();
+    while( it != entries.end() )
+    {
+        if( it.value().rGui )
+        {
+            discarded++;
+            delete it.value().rGui;     // Deletes the GUI with its scroll area, if any
+        }
+        ++it;
+    }
+    entries.clear();
+}
+
+//------------------------------------------------------------------------------
+// Summary suitable for presenting to the user
+QString formReusePool::getStatistics() const
+{
+    return QString( "Configuration restore: %1 restores, %2 GUIs reused, %3 GUIs not in the restored configuration deleted." )
+               .arg( restores )
+               .arg( reused )
+               .arg( discarded );
+}
+
+// end
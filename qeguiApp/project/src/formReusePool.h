@@ -0,0 +1,81 @@
+/*  formReusePool.h
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+/*
+ * DESCRIPTION:
+ *
+ * This class holds the GUIs that were open when a configuration restore was
+ * requested, so the restore can reuse them rather than re-create them.
+ *
+ * Before the current main windows are closed, each releases its GUIs (as is,
+ * with their scroll areas, PV connections and state) into the pool, keyed by the
+ * canonical path of the .ui file and the normalised macro substitutions saved
+ * with a GUI in a configuration (see formIndex::formKey()). As each GUI in the
+ * configuration is restored, a matching GUI is taken from the pool if there is
+ * one, and only if there is not is a new GUI created. The restored presentation
+ * (central, tab or dock, title, scroll position, etc) and the restored state of
+ * the GUI's widgets are then applied to the reused GUI exactly as they would be
+ * to a new one.
+ *
+ * Once the restore is complete the GUIs not reused (those not in the configuration)
+ * are deleted. So switching between configurations sharing most of their GUIs only
+ * creates and deletes the GUIs that differ.
+ */
+
+#ifndef QEGUI_FORM_REUSE_POOL_H
+#define QEGUI_FORM_REUSE_POOL_H
+
+#include <QMultiHash>
+#include <QPointer>
+#include <QString>
+#include <QWidget>
+
+class QEForm;
+class MainWindow;
+
+// Class holding GUIs released for reuse by a configuration restore
+class formReusePool
+{
+public:
+    formReusePool();
+    ~formReusePool();
+
+    // Add a GUI released from a main window. rGui is the widget holding the GUI (the GUI itself or its scroll area)
+    void add( const QString& key, QEForm* form, QWidget* rGui, MainWindow* from );
+
+    // Take a GUI matching a key (see formIndex::formKey()). Returns NULL if none.
+    // If found, the main window the GUI was released from is also returned.
+    QEForm* take( const QString& key, MainWindow** from );
+
+    bool isEmpty() const { return entries.isEmpty(); }
+    void clear();                                       // Delete all GUIs not reused
+
+    QString getStatistics() const;                      // Summary suitable for presenting to the user
+
+private:
+    class poolEntry
+    {
+    public:
+        QPointer<QEForm> form;                          // The released GUI
+        QPointer<QWidget> rGui;                         // Widget holding the GUI (the GUI itself or its scroll area)
+        QPointer<MainWindow> from;                      // Main window the GUI was released from
+    };
+
+    QMultiHash<QString, poolEntry> entries;             // Released GUIs by key
+
+    int restores;                                       // Number of restores that offered GUIs for reuse
+    int reused;                                         // Number of GUIs reused
+    int discarded;                                      // Number of GUIs deleted as they were not reused
+};
+
+#endif // QEGUI_FORM_REUSE_POOL_H
@@ -0,0 +1,311 @@
+/*  formSuspender.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+// Manage the suspension of GUIs that can't be seen. Refer to formSuspender.h for details.
+
+#include "formSuspender.h"
+#include <algorithm>
+#include <QDebug>
+#include <QList>
+#include <QPair>
+#include <QEForm.h>
+#include <QECommon.h>
+#include <QEWidget.h>
+
+#define DEBUG qDebug() << "formSuspender" << __LINE__ << __FUNCTION__ << "  "
+
+// Time a GUI must be out of sight before it is suspended (mS)
+#define SUSPEND_DELAY  2000
+
+// Number of GUIs listed individually in the statistics
+#define REPORT_FORMS   10
+
+//------------------------------------------------------------------------------
+// Construction
+formSuspender::formSuspender( QObject* parent ) : QObject( parent )
+{
+    requested = false;
+    shedding = false;
+    running = false;
+
+    timer.setInterval( SUSPEND_DELAY / 2 );
+    QObject::connect( &timer, SIGNAL( timeout() ), this, SLOT( checkHidden() ) );
+}
+
+formSuspender::~formSuspender()
+{
+}
+
+//------------------------------------------------------------------------------
+// Enable or disable suspension
+void formSuspender::setEnabled( const bool enabledIn )
+{
+    requested = enabledIn;
+    applyEnabled();
+}
+
+//------------------------------------------------------------------------------
+// Note the load on the GUI thread. While loaded, hidden GUIs are suspended to shed load.
+// Main windows report the visibility of their GUIs when the load level changes, so
+// the visibility of each GUI is known when suspension starts.
+void formSuspender::setLoadLevel( int level )
+{
+    shedding = level >= 1;
+    applyEnabled();
+}
+
+//------------------------------------------------------------------------------
+// Start or stop suspending according to the request and the load
+void formSuspender::applyEnabled()
+{
+    if( isEnabled() == running )
+    {
+        return;
+    }
+    running = isEnabled();
+
+    if( running )
+    {
+        timer.start();
+        return;
+    }
+
+    // No longer suspending. Re-activate any GUIs suspended.
+    timer.stop();
+    QHash<QEForm*, formState>::iterator it = forms.begin();
+    while( it != forms.end() )
+    {
+        if( it.value().suspended && !it.value().parked )
+        {
+            resume( it.key(), it.value() );
+        }
+        ++it;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Get the state of a GUI, tracking it if it is new
+formSuspender::formState& formSuspender::getState( QEForm* form )
+{
+    QHash<QEForm*, formState>::iterator it = forms.find( form );
+    if( it == forms.end() )
+    {
+        formState state;
+        state.visible = true;
+        state.suspended = false;
+        state.parked = false;
+        state.hiddenSince = 0;
+        state.suspendedSince = 0;
+        state.suspensions = 0;
+        state.widgetCount = 0;
+        state.suspendedTime = 0.0;
+        state.widgetTime = 0.0;
+        it = forms.insert( form, state );
+        QObject::connect( form, SIGNAL( destroyed( QObject* ) ), this, SLOT( formDestroyed( QObject* ) ) );
+    }
+    return it.value();
+}
+
+//------------------------------------------------------------------------------
+// Note if a GUI can be seen.
+// A GUI coming into view is resumed immediately. A GUI going out of view is
+// suspended by checkHidden() if it is still out of view a short time later.
+void formSuspender::setFormVisible( QEForm* form, const bool visible )
+{
+    if( !running || !form )
+    {
+        return;
+    }
+
+    formState& state = getState( form );
+    state.title = form->getQEGuiTitle();
+    if( state.parked || visible == state.visible )
+    {
+        return;
+    }
+    state.visible = visible;
+
+    if( visible )
+    {
+        if( state.suspended )
+        {
+            resume( form, state );
+        }
+    }
+    else
+    {
+        state.hiddenSince = QDateTime::currentMSecsSinceEpoch();
+    }
+}
+
+//------------------------------------------------------------------------------
+// Park or unpark a GUI.
+// A parked GUI is suspended straight away, whether or not suspension is enabled.
+// An unparked GUI is resumed. Its main window then reports its visibility as usual.
+void formSuspender::setFormParked( QEForm* form, const bool parked )
+{
+    if( !form )
+    {
+        return;
+    }
+
+    formState& state = getState( form );
+    state.title = form->getQEGuiTitle();
+    if( parked == state.parked )
+    {
+        return;
+    }
+    state.parked = parked;
+
+    if( parked )
+    {
+        state.visible = false;
+        state.hiddenSince = QDateTime::currentMSecsSinceEpoch();
+        if( !state.suspended )
+        {
+            suspend( form, state );
+        }
+    }
+    else
+    {
+        state.visible = true;
+        if( state.suspended )
+        {
+            resume( form, state );
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// Suspend any GUIs that have been out of view long enough
+void formSuspender::checkHidden()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    QHash<QEForm*, formState>::iterator it = forms.begin();
+    while( it != forms.end() )
+    {
+        formState& state = it.value();
+        if( !state.visible && !state.suspended && now - state.hiddenSince >= SUSPEND_DELAY )
+        {
+            suspend( it.key(), state );
+        }
+        ++it;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Deactivate a GUI's widgets
+void formSuspender::suspend( QEForm* form, formState& state )
+{
+    QEUtilities::deactivate( form );
+
+    // Count the QE widgets affected
+    int count = 0;
+    QList<QWidget*> widgets = form->findChildren<QWidget*>();
+    for( int i = 0; i < widgets.count(); i++ )
+    {
+        if( dynamic_cast<QEWidget*>( widgets[i] ) )
+        {
+            count++;
+        }
+    }
+
+    state.suspended = true;
+    state.suspendedSince = QDateTime::currentMSecsSinceEpoch();
+    state.suspensions++;
+    state.widgetCount = count;
+}
+
+//------------------------------------------------------------------------------
+// Re-activate a GUI's widgets. Reconnecting presents the latest values straight away.
+void formSuspender::resume( QEForm* form, formState& state )
+{
+    QEUtilities::activate( form );
+
+    const double seconds = ( QDateTime::currentMSecsSinceEpoch() - state.suspendedSince ) / 1000.0;
+    state.suspended = false;
+    state.suspendedTime += seconds;
+    state.widgetTime += seconds * state.widgetCount;
+}
+
+//------------------------------------------------------------------------------
+// A GUI has been closed
+void formSuspender::formDestroyed( QObject* form )
+{
+    // Only the pointer value is used, the object is no longer a QEForm
+    forms.remove( static_cast<QEForm*>( form ) );
+}
+
+//------------------------------------------------------------------------------
+// Summary suitable for presenting to the user.
+// Lists the totals, then the GUIs that have been suspended longest.
+QString formSuspender::getStatistics() const
+{
+    if( !requested && forms.isEmpty() )
+    {
+        return QString( "Hidden GUI suspension: not enabled (-q option)." );
+    }
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    // Gather the suspended time of each GUI, including any current suspension
+    QList<QPair<double, QEForm*> > suspendedForms;
+    int suspendedNow = 0;
+    int suspensions = 0;
+    double widgetTime = 0.0;
+    QHash<QEForm*, formState>::const_iterator it = forms.constBegin();
+    while( it != forms.constEnd() )
+    {
+        const formState& state = it.value();
+        double seconds = state.suspendedTime;
+        double widgetSeconds = state.widgetTime;
+        if( state.suspended )
+        {
+            const double current = ( now - state.suspendedSince ) / 1000.0;
+            seconds += current;
+            widgetSeconds += current * state.widgetCount;
+            suspendedNow++;
+        }
+        suspensions += state.suspensions;
+        widgetTime += widgetSeconds;
+        if( state.suspensions )
+        {
+            suspendedForms.append( QPair<double, QEForm*>( seconds, it.key() ) );
+        }
+        ++it;
+    }
+    std::sort( suspendedForms.begin(), suspendedForms.end() );
+
+    QString statistics = QString( "Hidden GUI suspension%1: %2 GUIs tracked, %3 suspended now, %4 suspensions, %5 widget-seconds of PV updates avoided." )
+                             .arg( requested ? "" : shedding ? " (shedding load)" : " (when loaded)" )
+                             .arg( forms.count() )
+                             .arg( suspendedNow )
+                             .arg( suspensions )
+                             .arg( widgetTime, 0, 'f', 0 );
+
+    for( int i = suspendedForms.count() - 1; i >= 0 && i >= suspendedForms.count() - REPORT_FORMS; i-- )
+    {
+        const formState& state = forms.value( suspendedForms[i].second );
+        statistics.append( QString( "\n   %1: suspended %2 times, %3 S in total, %4 widgets%5" )
+                               .arg( state.title )
+                               .arg( state.suspensions )
+                               .arg( suspendedForms[i].first, 0, 'f', 0 )
+                               .arg( state.widgetCount )
+                               .arg( state.suspended ? " (suspended now)" : "" ) );
+    }
+
+    return statistics;
+}
+
+// end
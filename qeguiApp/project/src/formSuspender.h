@@ -0,0 +1,105 @@
+/*  formSuspender.h
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+/*
+ * DESCRIPTION:
+ *
+ * When requested (-q option) GUIs that can't be seen - those in tabs other than
+ * the current tab, in hidden docks, or in minimised main windows - are suspended.
+ * All the QE widgets in a suspended GUI are deactivated (QEUtilities::deactivate()),
+ * so they stop receiving and presenting PV updates. When the GUI can be seen
+ * again the widgets are re-activated, which reconnects them and presents the
+ * latest values straight away.
+ *
+ * A GUI is only suspended once it has been out of sight for a short time, so
+ * flicking between tabs does not repeatedly disconnect and reconnect PVs.
+ *
+ * Suspension is also used to shed load when adaptive refresh governing is
+ * requested (-A option). While the GUI thread is loaded (refer to refreshGovernor)
+ * hidden GUIs are suspended even if the -q option was not given.
+ *
+ * GUIs in main windows kept hidden in a workspace that is not in use (refer to
+ * workspaceManager.h) are 'parked'. A parked GUI is suspended straight away,
+ * whether or not suspension is enabled, and stays suspended until unparked.
+ *
+ * Main windows report the visibility of their GUIs as it changes. Counters are
+ * kept for each GUI so the effect can be confirmed from the 'About' dialog.
+ */
+
+#ifndef QEGUI_FORM_SUSPENDER_H
+#define QEGUI_FORM_SUSPENDER_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QHash>
+#include <QString>
+#include <QTimer>
+
+class QEForm;
+
+// Class managing the suspension of GUIs that can't be seen
+class formSuspender : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit formSuspender( QObject* parent = 0 );
+    ~formSuspender();
+
+    void setEnabled( const bool enabledIn );            // Enable or disable suspension. (Disabling re-activates all suspended GUIs)
+    bool isEnabled() const { return requested || shedding; }
+
+    void setFormVisible( QEForm* form, const bool visible );   // Note if a GUI can be seen
+    void setFormParked( QEForm* form, const bool parked );     // Park (suspend regardless) or unpark a GUI
+
+    QString getStatistics() const;                      // Summary suitable for presenting to the user
+
+public slots:
+    void setLoadLevel( int level );                     // Suspend hidden GUIs while the GUI thread is loaded (level 1 or more)
+
+private:
+    // Suspension state and counters for a GUI
+    class formState
+    {
+    public:
+        QString title;                  // GUI title (for reporting)
+        bool visible;                   // True if the GUI can be seen
+        bool suspended;                 // True if the GUI's widgets are deactivated
+        bool parked;                    // True if the GUI is parked in a workspace not in use
+        qint64 hiddenSince;             // Time the GUI was last hidden (mS since epoch)
+        qint64 suspendedSince;          // Time the GUI was last suspended (mS since epoch)
+        int suspensions;                // Number of times suspended
+        int widgetCount;                // Number of QE widgets deactivated when last suspended
+        double suspendedTime;           // Total time suspended (S), excluding any current suspension
+        double widgetTime;              // Total widget-seconds suspended (widgets deactivated x time suspended)
+    };
+
+    QHash<QEForm*, formState> forms;    // All GUIs reported
+
+    formState& getState( QEForm* form );                // Get the state of a GUI, tracking it if new
+    void suspend( QEForm* form, formState& state );     // Deactivate a GUI's widgets
+    void resume( QEForm* form, formState& state );      // Re-activate a GUI's widgets
+
+    void applyEnabled();                                // Start or stop suspending according to the request and the load
+
+    bool requested;                     // True if suspension was requested (-q option)
+    bool shedding;                      // True if suspending to shed load
+    bool running;                       // True while suspending
+    QTimer timer;                       // Checks for GUIs hidden for long enough to suspend
+
+private slots:
+    void checkHidden();
+    void formDestroyed( QObject* form );
+};
+
+#endif // QEGUI_FORM_SUSPENDER_H
@@ -0,0 +1,352 @@
+/*  geometryRestore.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+// Apply restored main window geometry. Refer to geometryRestore.h for details.
+
+#include "geometryRestore.h"
+#include <QDebug>
+#include <QEvent>
+#include <QWindow>
+#include <MainWindow.h>
+#include <QECommon.h>
+
+#define DEBUG qDebug() << "geometryRestore" << __LINE__ << __FUNCTION__ << "  "
+
+// Maximum wait for the window manager to decorate, or to resize, restored windows
+#define GEOMETRY_RESTORE_DEADLINE  10000
+
+// Wait for the rest of a batch once the first window has been decorated (and the rest mapped)
+#define GEOMETRY_RESTORE_GRACE     500
+
+//------------------------------------------------------------------------------
+// Construction
+geometryRestore::geometryRestore( QObject* parent ) : QObject( parent )
+{
+    windowCount = 0;
+    batchCount = 0;
+    deadlineCount = 0;
+    lastBatchTime = 0;
+    lastScrollTime = 0;
+
+    deadline.setSingleShot( true );
+    QObject::connect( &deadline, SIGNAL( timeout() ), this, SLOT( deadlineExpired() ) );
+}
+
+geometryRestore::~geometryRestore()
+{
+}
+
+//------------------------------------------------------------------------------
+// Note the geometry to be applied to a main window being restored.
+// Called while the main window is being constructed, before it is shown.
+void geometryRestore::add( MainWindow* mw, const QRect& geometry )
+{
+    // Start a new batch if required
+    bool batchStarted = false;
+    QHashIterator<MainWindow*, pendingWindow> it( pending );
+    while( it.hasNext() )
+    {
+        it.next();
+        if( it.value().state != WAITING_FOR_SIZE )
+        {
+            batchStarted = true;
+            break;
+        }
+    }
+    if( !batchStarted )
+    {
+        batchTimer.start();
+        deadline.start( GEOMETRY_RESTORE_DEADLINE );
+    }
+
+    if( !pending.contains( mw ) )
+    {
+        mw->installEventFilter( this );
+        QObject::connect( mw, SIGNAL( destroyed( QObject* ) ), this, SLOT( windowDestroyed( QObject* ) ) );
+    }
+
+    pendingWindow window;
+    window.geometry = geometry;
+    window.state = WAITING_FOR_DECORATION;
+    pending.insert( mw, window );
+    windowCount++;
+}
+
+//------------------------------------------------------------------------------
+// Watch the window system events of windows being restored
+bool geometryRestore::eventFilter( QObject* watched, QEvent* event )
+{
+    switch( event->type() )
+    {
+        case QEvent::Show:
+        case QEvent::Expose:
+        case QEvent::Move:
+        case QEvent::Resize:
+        case QEvent::WindowStateChange:
+        {
+            MainWindow* mw = static_cast<MainWindow*>( watched );
+            QHash<MainWindow*, pendingWindow>::iterator it = pending.find( mw );
+            if( it == pending.end() )
+            {
+                break;
+            }
+
+            switch( it.value().state )
+            {
+                case WAITING_FOR_DECORATION:
+                    if( isReady( mw ) )
+                    {
+                        it.value().state = DECORATED;
+                        checkBatch();
+                    }
+                    else if( isMapped( mw ) )
+                    {
+                        // Now mapped, the rest of the batch may only need a short wait
+                        checkBatch();
+                    }
+                    break;
+
+                case WAITING_FOR_SIZE:
+                    if( mw->size() == it.value().geometry.size() )
+                    {
+                        applyScroll( mw );
+                    }
+                    break;
+
+                default:
+                    break;
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    return QObject::eventFilter( watched, event );
+}
+
+//------------------------------------------------------------------------------
+// Return true if a window is ready for its geometry to be applied.
+// When decorations have been added, the position of the window geometry and frame geometry will differ.
+// A minimised window will not be decorated until it is shown, so don't hold up the batch for it.
+bool geometryRestore::isReady( MainWindow* mw ) const
+{
+    return mw->geometry().topLeft() != mw->frameGeometry().topLeft() ||
+           ( mw->windowState() & Qt::WindowMinimized );
+}
+
+//------------------------------------------------------------------------------
+// Return true if a window has been mapped (exposed) by the window manager
+bool geometryRestore::isMapped( MainWindow* mw )
+{
+    QWindow* window = mw->windowHandle();
+    return window && window->isExposed();
+}
+
+//------------------------------------------------------------------------------
+// Apply the batch if all windows are ready.
+// If not, and at least one window has been decorated, the window manager is likely
+// to be decorating the rest at about the same time, so only wait a short time for
+// them. This is only done once they have all been mapped, as until then the window
+// manager can't have started on them.
+void geometryRestore::checkBatch()
+{
+    bool waiting = false;
+    bool allMapped = true;
+    bool anyDecorated = false;
+
+    QHashIterator<MainWindow*, pendingWindow> it( pending );
+    while( it.hasNext() )
+    {
+        it.next();
+        if( it.value().state == WAITING_FOR_DECORATION )
+        {
+            waiting = true;
+            if( !isMapped( it.key() ) )
+            {
+                allMapped = false;
+            }
+        }
+        else if( it.value().state == DECORATED )
+        {
+            anyDecorated = true;
+        }
+    }
+
+    if( !waiting )
+    {
+        applyBatch();
+        return;
+    }
+
+    if( anyDecorated && allMapped && deadline.remainingTime() > GEOMETRY_RESTORE_GRACE )
+    {
+        deadline.start( GEOMETRY_RESTORE_GRACE );
+    }
+}
+
+//------------------------------------------------------------------------------
+// Apply the geometry of all windows waiting, ensuring each is at least partially on screen.
+void geometryRestore::applyBatch()
+{
+    deadline.stop();
+
+    // Note the windows to apply first, as applying the geometry may deliver events synchronously
+    QList<MainWindow*> batch;
+    QHashIterator<MainWindow*, pendingWindow> it( pending );
+    while( it.hasNext() )
+    {
+        it.next();
+        if( it.value().state != WAITING_FOR_SIZE )
+        {
+            batch.append( it.key() );
+        }
+    }
+
+    const QRect desktopGeometry = QEUtilities::desktopGeometry();
+    const int leftLimit   = desktopGeometry.left()   + 100;
+    const int rightLimit  = desktopGeometry.right()  - 100;
+    const int limitTop    = desktopGeometry.top()    + 50;
+    const int limitBottom = desktopGeometry.bottom() - 50;
+
+    for( int i = 0; i < batch.count(); i++ )
+    {
+        MainWindow* mw = batch[i];
+        QRect geometry = pending[mw].geometry;
+
+        // Ensure restored window geometry is at least partially on screen.
+        if( geometry.right() <= leftLimit )
+        {
+            geometry.moveRight( leftLimit );
+        }
+        else if( geometry.left() >= rightLimit )
+        {
+            geometry.moveLeft( rightLimit );
+        }
+
+        if( geometry.top() <= limitTop )
+        {
+            // Need top of window on screen.
+            geometry.moveTop( limitTop );
+        }
+        else if( geometry.top() >= limitBottom )
+        {
+            geometry.moveTop( limitBottom );
+        }
+
+        // Note the state before setting the geometry, as the resulting resize event may be delivered immediately
+        pending[mw].geometry = geometry;
+        pending[mw].state = WAITING_FOR_SIZE;
+        mw->setGeometry( geometry );
+    }
+
+    batchCount++;
+    lastBatchTime = batchTimer.elapsed();
+
+    // Apply the scroll positions of any window already at the required size.
+    // The rest will be applied as their resize events arrive.
+    for( int i = 0; i < batch.count(); i++ )
+    {
+        MainWindow* mw = batch[i];
+        if( pending.contains( mw ) && mw->size() == pending[mw].geometry.size() )
+        {
+            applyScroll( mw );
+        }
+    }
+
+    if( !pending.isEmpty() )
+    {
+        deadline.start( GEOMETRY_RESTORE_DEADLINE );
+    }
+}
+
+//------------------------------------------------------------------------------
+// Apply the scroll positions of a window, and stop watching it
+void geometryRestore::applyScroll( MainWindow* mw )
+{
+    pending.remove( mw );
+    mw->removeEventFilter( this );
+    QObject::disconnect( mw, SIGNAL( destroyed( QObject* ) ), this, SLOT( windowDestroyed( QObject* ) ) );
+
+    mw->applyRestoredScroll();
+    lastScrollTime = batchTimer.elapsed();
+
+    if( pending.isEmpty() )
+    {
+        deadline.stop();
+    }
+}
+
+//------------------------------------------------------------------------------
+// The wait has been too long.
+// Apply the geometry of any windows not yet decorated, or if all geometry has been
+// applied, the scroll positions of any windows the window manager has not resized.
+// (The window manager may not be willing to set the size requested, for example if
+// the display size has changed since the configuration was saved)
+void geometryRestore::deadlineExpired()
+{
+    deadlineCount++;
+
+    bool waitingForDecoration = false;
+    QHashIterator<MainWindow*, pendingWindow> it( pending );
+    while( it.hasNext() )
+    {
+        it.next();
+        if( it.value().state != WAITING_FOR_SIZE )
+        {
+            waitingForDecoration = true;
+            break;
+        }
+    }
+
+    if( waitingForDecoration )
+    {
+        applyBatch();
+        return;
+    }
+
+    QList<MainWindow*> windows = pending.keys();
+    for( int i = 0; i < windows.count(); i++ )
+    {
+        applyScroll( windows[i] );
+    }
+}
+
+//------------------------------------------------------------------------------
+// A window being restored has been deleted
+void geometryRestore::windowDestroyed( QObject* object )
+{
+    // Only the pointer value is used, the window is no longer a MainWindow
+    pending.remove( static_cast<MainWindow*>( object ) );
+
+    if( pending.isEmpty() )
+    {
+        deadline.stop();
+    }
+}
+
+//------------------------------------------------------------------------------
+// Summary suitable for presenting to the user
+QString geometryRestore::getStatistics() const
+{
+    return QString( "Geometry restore: %1 windows in %2 batches (%3 deadline expiries), last batch applied after %4 mS, scroll positions after %5 mS, %6 windows waiting." )
+               .arg( windowCount )
+               .arg( batchCount )
+               .arg( deadlineCount )
+               .arg( lastBatchTime )
+               .arg( lastScrollTime )
+               .arg( pending.count() );
+}
+
+// end
@@ -0,0 +1,103 @@
+/*  geometryRestore.h
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+/*
+ * DESCRIPTION:
+ *
+ * This class applies the geometry and scroll positions of main windows when a
+ * configuration is restored.
+ *
+ * Under X11, setting the geometry of a newly created window is complicated by the
+ * window manager. The saved position includes the window decorations, so it must
+ * be applied after the window manager has added them, or the window will be moved
+ * when they are added. The window manager operates asynchronously, so the addition
+ * of the decorations is inferred when the window geometry and frame geometry differ.
+ * Similarly, the scroll positions of the GUIs in a window can only be applied once
+ * the window manager has resized the window.
+ *
+ * Rather than polling each window, the window system events delivered to each
+ * restored window (show, expose, move, resize and state changes) are watched.
+ * When every restored window has been decorated the geometry of all of them is
+ * applied in one pass, and each window's scroll positions are applied when its
+ * resize arrives. Window managers tend to decorate all new windows together, so
+ * once the first window has been decorated, and the rest have at least been mapped
+ * (exposed), the rest are given only a short grace period. A window not yet mapped
+ * may simply be slow to appear, so is not rushed. A single deadline ensures nothing
+ * waits forever, for example when no window manager is running or it adds no
+ * decorations to the top or left.
+ */
+
+#ifndef QEGUI_GEOMETRY_RESTORE_H
+#define QEGUI_GEOMETRY_RESTORE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QRect>
+#include <QString>
+#include <QTimer>
+
+class MainWindow;
+
+// Class managing the application of restored main window geometry
+class geometryRestore : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit geometryRestore( QObject* parent = 0 );
+    ~geometryRestore();
+
+    // Note the geometry to be applied to a main window being restored
+    void add( MainWindow* mw, const QRect& geometry );
+
+    QString getStatistics() const;                      // Summary suitable for presenting to the user
+
+protected:
+    bool eventFilter( QObject* watched, QEvent* event );
+
+private:
+    // State of each main window being restored
+    enum restoreStates { WAITING_FOR_DECORATION,        // Waiting for the window manager to decorate the window
+                         DECORATED,                     // Decorated, waiting for the rest of the batch
+                         WAITING_FOR_SIZE };            // Geometry applied, waiting for the window manager to set the size
+    class pendingWindow
+    {
+    public:
+        QRect geometry;                                 // Geometry to apply
+        restoreStates state;
+    };
+
+    QHash<MainWindow*, pendingWindow> pending;          // Windows being restored
+
+    bool isReady( MainWindow* mw ) const;               // Return true if a window is ready for its geometry to be applied
+    static bool isMapped( MainWindow* mw );             // Return true if a window has been mapped (exposed) by the window manager
+    void checkBatch();                                  // Apply the batch if all windows are ready
+    void applyBatch();                                  // Apply the geometry of all windows waiting
+    void applyScroll( MainWindow* mw );                 // Apply the scroll positions of a window, and stop watching it
+
+    QTimer deadline;                                    // Single timer limiting the wait
+    QElapsedTimer batchTimer;                           // Time since the first window of the current batch was added
+
+    int windowCount;                                    // Number of windows restored
+    int batchCount;                                     // Number of batches applied
+    int deadlineCount;                                  // Number of batches applied by the deadline (rather than by events)
+    qint64 lastBatchTime;                               // Time to apply the last batch (mS)
+    qint64 lastScrollTime;                              // Time until the last scroll positions were applied (mS)
+
+private slots:
+    void deadlineExpired();
+    void windowDestroyed( QObject* object );
+};
+
+#endif // QEGUI_GEOMETRY_RESTORE_H
@@ -0,0 +1,40 @@
+/*  guiPlaceholder.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+// Stand in for a GUI not yet created. Refer to guiPlaceholder.h for details.
+
+#include "guiPlaceholder.h"
+#include <QLabel>
+#include <QVBoxLayout>
+
+guiPlaceholder::guiPlaceholder( const QString& fileNameIn, const QString& titleIn,
+                                const QString& customisationNameIn, const QString& restoreIdIn,
+                                const QStringList& pathListIn, const QString& macroSubstitutionsIn,
+                                QWidget* parent ) : QWidget( parent )
+{
+    fileName = fileNameIn;
+    title = titleIn;
+    customisationName = customisationNameIn;
+    restoreId = restoreIdIn;
+    pathList = pathListIn;
+    macroSubstitutions = macroSubstitutionsIn;
+    hasScroll = false;
+
+    // Present a brief note of the GUI this stands for. (Only seen briefly, if at all)
+    QLabel* label = new QLabel( QString( "Opening %1" ).arg( title.isEmpty() ? fileName : title ), this );
+    label->setAlignment( Qt::AlignCenter );
+    QVBoxLayout* layout = new QVBoxLayout( this );
+    layout->addWidget( label );
+}
+
+// end
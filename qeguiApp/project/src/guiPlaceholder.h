@@ -0,0 +1,57 @@
+/*  guiPlaceholder.h
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+/*
+ * DESCRIPTION:
+ *
+ * When a configuration is restored in lazy mode (-l option) GUIs in tabs other
+ * than the current tab, and GUIs in hidden docks, are not created straight away.
+ * An instance of this class takes the place of each in the tab or dock. It holds
+ * everything needed to create the GUI (and to save it again in a configuration
+ * if it is never created), and presents a brief note of the GUI it stands for.
+ *
+ * The main window replaces the placeholder with the real GUI when the tab is
+ * first selected or the dock is first shown.
+ */
+
+#ifndef QEGUI_GUI_PLACEHOLDER_H
+#define QEGUI_GUI_PLACEHOLDER_H
+
+#include <QWidget>
+#include <QPoint>
+#include <QString>
+#include <QStringList>
+
+// Class standing in for a GUI not yet created
+class guiPlaceholder : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit guiPlaceholder( const QString& fileNameIn, const QString& titleIn,
+                             const QString& customisationNameIn, const QString& restoreIdIn,
+                             const QStringList& pathListIn, const QString& macroSubstitutionsIn,
+                             QWidget* parent = 0 );
+
+    QString fileName;               // GUI file name
+    QString title;                  // GUI title
+    QString customisationName;      // Window customisations
+    QString restoreId;              // Unique identifier of the GUI (used by the GUI to restore its own configuration)
+    QString saveId;                 // Unique identifier the placeholder is saved with (see MainWindow::identifyWindowAndForms())
+    QStringList pathList;           // Paths for locating other files
+    QString macroSubstitutions;     // Macro substitutions
+    bool hasScroll;                 // True if a scroll position is to be applied to the GUI
+    QPoint scroll;                  // Scroll position to apply to the GUI
+};
+
+#endif // QEGUI_GUI_PLACEHOLDER_H
@@ -0,0 +1,171 @@
+/*  launchBatch.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+// Run the launch of a number of GUIs as a single transaction. Refer to launchBatch.h for details.
+
+#include "launchBatch.h"
+#include <QEForm.h>
+#include <QEGui.h>
+#include <MainWindow.h>
+
+//------------------------------------------------------------------------------
+// Construction
+launchBatch::launchBatch( QEGui* appIn )
+{
+    app = appIn;
+    depth = 0;
+    batches = 0;
+    requested = 0;
+    applied = 0;
+    windowsShown = 0;
+}
+
+launchBatch::~launchBatch()
+{
+}
+
+//------------------------------------------------------------------------------
+// Start a batch launched from a main window
+void launchBatch::begin( MainWindow* launcher )
+{
+    depth++;
+    if( launcher )
+    {
+        suspendPainting( launcher );
+    }
+}
+
+//------------------------------------------------------------------------------
+// Complete a batch.
+// Apply the customisations noted, update the 'Recent...' list, show all new main windows, and resume painting.
+void launchBatch::end()
+{
+    if( depth == 0 || --depth > 0 )
+    {
+        return;
+    }
+    batches++;
+
+    // Apply each customisation once per main window
+    const QList<customisationEntry> pendingCustomisations = customisations;
+    customisations.clear();
+    for( int i = 0; i < pendingCustomisations.count(); i++ )
+    {
+        MainWindow* mw = pendingCustomisations[i].mainWindow;
+        if( mw )
+        {
+            mw->applyGuiCustomisation( pendingCustomisations[i].name );
+            applied++;
+        }
+    }
+
+    // Add the GUIs to the 'Recent...' list (the 'Recent...' menus are rebuilt when next shown)
+    const QList<recentEntry> pendingRecent = recent;
+    recent.clear();
+    for( int i = 0; i < pendingRecent.count(); i++ )
+    {
+        if( pendingRecent[i].gui )
+        {
+            app->addGui( pendingRecent[i].gui, pendingRecent[i].customisationName );
+        }
+    }
+
+    // Show all new main windows together
+    const QList<QPointer<MainWindow> > pendingWindows = newWindows;
+    newWindows.clear();
+    for( int i = 0; i < pendingWindows.count(); i++ )
+    {
+        if( pendingWindows[i] )
+        {
+            pendingWindows[i]->show();
+            windowsShown++;
+        }
+    }
+
+    // Resume painting
+    const QList<QPointer<MainWindow> > pendingPainting = suspended;
+    suspended.clear();
+    for( int i = 0; i < pendingPainting.count(); i++ )
+    {
+        if( pendingPainting[i] )
+        {
+            pendingPainting[i]->setUpdatesEnabled( true );
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// Suspend painting a main window until the batch completes
+void launchBatch::suspendPainting( MainWindow* mw )
+{
+    if( suspended.contains( mw ) || !mw->updatesEnabled() )
+    {
+        return;
+    }
+    mw->setUpdatesEnabled( false );
+    suspended.append( mw );
+}
+
+//------------------------------------------------------------------------------
+// Note the customisation required by a GUI in a main window.
+// If the same customisation has already been noted for the main window it is moved to the end,
+// so customisations are applied in the order they were last requested.
+void launchBatch::deferCustomisation( MainWindow* mw, const QString& customisationName )
+{
+    requested++;
+    suspendPainting( mw );
+
+    for( int i = 0; i < customisations.count(); i++ )
+    {
+        if( customisations[i].mainWindow == mw && customisations[i].name == customisationName )
+        {
+            customisations.removeAt( i );
+            break;
+        }
+    }
+
+    customisationEntry entry;
+    entry.mainWindow = mw;
+    entry.name = customisationName;
+    customisations.append( entry );
+}
+
+//------------------------------------------------------------------------------
+// Note a GUI to add to the 'Recent...' list
+void launchBatch::deferRecent( QEForm* gui, const QString& customisationName )
+{
+    recentEntry entry;
+    entry.gui = gui;
+    entry.customisationName = customisationName;
+    recent.append( entry );
+}
+
+//------------------------------------------------------------------------------
+// Note a new main window to show
+void launchBatch::deferShow( MainWindow* mw )
+{
+    newWindows.append( mw );
+}
+
+//------------------------------------------------------------------------------
+// Summary suitable for presenting to the user
+QString launchBatch::getStatistics() const
+{
+    return QString( "Launch batches: %1 batches, %2 customisations requested, %3 applied, %4 new main windows shown together." )
+               .arg( batches )
+               .arg( requested )
+               .arg( applied )
+               .arg( windowsShown );
+}
+
+// end
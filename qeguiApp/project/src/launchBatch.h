@@ -0,0 +1,98 @@
+/*  launchBatch.h
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+/*
+ * DESCRIPTION:
+ *
+ * This class runs the launch of a number of GUIs as a single transaction.
+ *
+ * A single request may open many GUIs (for example, a QEPushButton or custom menu
+ * item opening a set of windows and docks). Launched one at a time, each GUI
+ * applies its main window's customisation (rebuilding menus and tool bars), is
+ * added to the 'Recent...' list, and is shown straight away, so main windows
+ * repaint and flicker as each GUI arrives.
+ *
+ * While a batch is active:
+ *    - painting of the main windows involved is suspended
+ *    - the customisation required by GUIs in each main window is noted rather than
+ *      applied. Each distinct customisation is applied once per main window when
+ *      the batch completes
+ *    - GUIs are noted rather than added to the 'Recent...' list
+ *    - new main windows are not shown
+ *
+ * When the batch completes the customisations are applied, the 'Recent...' list
+ * is updated, all new main windows are shown together and painting is resumed.
+ * Batches may be nested, only the outermost batch completing has any effect.
+ */
+
+#ifndef QEGUI_LAUNCH_BATCH_H
+#define QEGUI_LAUNCH_BATCH_H
+
+#include <QList>
+#include <QPointer>
+#include <QString>
+
+class QEGui;
+class QEForm;
+class MainWindow;
+
+// Class running the launch of a number of GUIs as a single transaction
+class launchBatch
+{
+public:
+    explicit launchBatch( QEGui* appIn );
+    ~launchBatch();
+
+    void begin( MainWindow* launcher );                 // Start a batch launched from a main window
+    void end();                                         // Complete a batch
+    bool isActive() const { return depth > 0; }
+
+    // Work deferred until the batch completes
+    void deferCustomisation( MainWindow* mw, const QString& customisationName );   // Apply a GUI's customisation to a main window
+    void deferRecent( QEForm* gui, const QString& customisationName );             // Add a GUI to the 'Recent...' list
+    void deferShow( MainWindow* mw );                   // Show a new main window
+
+    QString getStatistics() const;                      // Summary suitable for presenting to the user
+
+private:
+    void suspendPainting( MainWindow* mw );             // Suspend painting a main window until the batch completes
+
+    class customisationEntry
+    {
+    public:
+        QPointer<MainWindow> mainWindow;
+        QString name;
+    };
+
+    class recentEntry
+    {
+    public:
+        QPointer<QEForm> gui;
+        QString customisationName;
+    };
+
+    QEGui* app;
+    int depth;                                          // Nesting depth of active batches
+
+    QList<QPointer<MainWindow> > suspended;             // Main windows with painting suspended
+    QList<customisationEntry> customisations;           // Customisations to apply, in order of last use
+    QList<recentEntry> recent;                          // GUIs to add to the 'Recent...' list, in order launched
+    QList<QPointer<MainWindow> > newWindows;            // New main windows to show
+
+    int batches;                                        // Number of batches completed
+    int requested;                                      // Number of customisations requested during batches
+    int applied;                                        // Number of customisations applied
+    int windowsShown;                                   // Number of new main windows shown together
+};
+
+#endif // QEGUI_LAUNCH_BATCH_H
@@ -40,6 +40,18 @@ int main(int argc, char *argv[])
     QCoreApplication::setAttribute( Qt::AA_ShareOpenGLContexts );
 #endif
 
+    // Benchmark runs are headless, unless a platform has been explicitly chosen.
+    //
+    if (qEnvironmentVariableIsEmpty ("QT_QPA_PLATFORM")) {
+        for (int j = 1; j < argc; j++) {
+            const QString arg (argv[j]);
+            if ((arg == "-B") || (arg == "--benchmark") || arg.startsWith ("--benchmark=")) {
+                qputenv ("QT_QPA_PLATFORM", "offscreen");
+                break;
+            }
+        }
+    }
+
     QEGui* app = new QEGui( argc, argv );
     int ret = app->run();
     delete app;
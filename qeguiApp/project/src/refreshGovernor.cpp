@@ -0,0 +1,472 @@
+/*  refreshGovernor.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+// Limit the rate at which main windows are repainted. Refer to refreshGovernor.h for details.
+
+#include "refreshGovernor.h"
+#include <QApplication>
+#include <QDebug>
+#include <QDockWidget>
+#include <QEvent>
+#include <QList>
+
+#define DEBUG qDebug() << "refreshGovernor" << __LINE__ << __FUNCTION__ << "  "
+
+// Highest repaint rate that may be requested (Hz)
+#define MAX_REFRESH_RATE      1000.0
+
+// Full repaint rate of throttled windows when no maximum rate has been set (Hz)
+#define ADAPTIVE_BASE_RATE    60.0
+
+// Interval between rate measurements (mS)
+#define RATE_INTERVAL         1000
+
+// Interval of the timer used to measure event loop lag (mS)
+#define LAG_INTERVAL          100
+
+// Load thresholds. The load level is raised if either the event loop lag or the proportion of time
+// spent repainting is above the high threshold, and lowered when both are below the low threshold.
+#define LAG_HIGH              50
+#define LAG_LOW               20
+#define PAINT_LOAD_HIGH       0.5
+#define PAINT_LOAD_LOW        0.25
+
+// Highest load level
+#define MAX_LOAD_LEVEL        4
+
+//------------------------------------------------------------------------------
+// Construction
+refreshGovernor::refreshGovernor( QObject* parent ) : QObject( parent )
+{
+    maxRate = 0.0;
+    adaptive = false;
+    running = false;
+    releasing = false;
+
+    updates = 0;
+    repaints = 0;
+    updateRate = 0.0;
+    repaintRate = 0.0;
+    peakUpdateRate = 0.0;
+    peakRepaintRate = 0.0;
+    totalUpdates = 0;
+    totalRepaints = 0;
+    totalHeld = 0;
+
+    maxLag = 0;
+    paintTime = 0;
+    lastLag = 0;
+    lastPaintLoad = 0.0;
+    loadLevel = 0;
+    peakLoadLevel = 0;
+    loadLevelChanges = 0;
+
+    tickTimer.setTimerType( Qt::PreciseTimer );
+    QObject::connect( &tickTimer, SIGNAL( timeout() ), this, SLOT( tick() ) );
+
+    rateTimer.setInterval( RATE_INTERVAL );
+    QObject::connect( &rateTimer, SIGNAL( timeout() ), this, SLOT( measureRates() ) );
+
+    lagTimer.setTimerType( Qt::PreciseTimer );
+    lagTimer.setInterval( LAG_INTERVAL );
+    QObject::connect( &lagTimer, SIGNAL( timeout() ), this, SLOT( checkLag() ) );
+}
+
+refreshGovernor::~refreshGovernor()
+{
+}
+
+//------------------------------------------------------------------------------
+// Set the maximum repaint rate. Zero (or less) for no limit.
+void refreshGovernor::setMaxRate( const double maxRateIn )
+{
+    maxRate = maxRateIn > 0.0 ? qMin( maxRateIn, MAX_REFRESH_RATE ) : 0.0;
+    tickTimer.setInterval( qMax( 1, qRound( 1000.0 / ( maxRate > 0.0 ? maxRate : ADAPTIVE_BASE_RATE ) ) ) );
+    if( isEnabled() )
+    {
+        start();
+    }
+    else
+    {
+        stop();
+    }
+}
+
+//------------------------------------------------------------------------------
+// Throttle lower priority GUIs as the load on the GUI thread rises, or not.
+void refreshGovernor::setAdaptive( const bool adaptiveIn )
+{
+    adaptive = adaptiveIn;
+    if( adaptive )
+    {
+        lagInterval.start();
+        lagTimer.start();
+    }
+    else
+    {
+        lagTimer.stop();
+        setLoadLevel( 0 );
+    }
+    if( isEnabled() )
+    {
+        start();
+    }
+    else
+    {
+        stop();
+    }
+}
+
+//------------------------------------------------------------------------------
+// Start watching events.
+// The governor only watches events while enabled.
+void refreshGovernor::start()
+{
+    if( running )
+    {
+        return;
+    }
+    running = true;
+
+    clock.start();
+    QCoreApplication::instance()->installEventFilter( this );
+    rateInterval.start();
+    rateTimer.start();
+}
+
+//------------------------------------------------------------------------------
+// Stop watching events. Deliver anything held back first.
+void refreshGovernor::stop()
+{
+    if( !running )
+    {
+        return;
+    }
+
+    QList<QObject*> keys = windows.keys();
+    for( int i = 0; i < keys.count(); i++ )
+    {
+        QHash<QObject*, windowState>::iterator it = windows.find( keys[i] );
+        if( it != windows.end() && it.value().held && it.value().window )
+        {
+            deliver( it.value().window );
+        }
+    }
+
+    running = false;
+    tickTimer.stop();
+    rateTimer.stop();
+    QCoreApplication::instance()->removeEventFilter( this );
+}
+
+//------------------------------------------------------------------------------
+// Return the throttle factor for a window given its priority and the load.
+// The window with focus is never throttled. As the load rises, main windows are
+// throttled first, then floating docks. (Background tabs are suspended before either)
+int refreshGovernor::windowFactor( QWidget* window ) const
+{
+    if( loadLevel < 2 || window == QApplication::activeWindow() )
+    {
+        return 1;
+    }
+
+    if( qobject_cast<QDockWidget*>( window ) )
+    {
+        return loadLevel >= 3 ? 1 << ( loadLevel - 2 ) : 1;
+    }
+
+    return 1 << ( loadLevel - 1 );
+}
+
+//------------------------------------------------------------------------------
+// Return the minimum time between repaints of a window (mS).
+// Windows at full rate are only limited if a maximum rate has been set.
+qint64 refreshGovernor::windowInterval( const int factor ) const
+{
+    if( maxRate <= 0.0 && factor == 1 )
+    {
+        return 0;
+    }
+    return qRound( 1000.0 * factor / ( maxRate > 0.0 ? maxRate : ADAPTIVE_BASE_RATE ) );
+}
+
+//------------------------------------------------------------------------------
+// Count updates in and repaints out, and hold back update requests to top level
+// windows arriving too soon after the last repaint.
+bool refreshGovernor::eventFilter( QObject* watched, QEvent* event )
+{
+    switch( event->type() )
+    {
+        case QEvent::MetaCall:
+            // Queued signal delivery. Predominantly PV updates from the channel access threads.
+            updates++;
+            break;
+
+        case QEvent::UpdateRequest:
+            if( !releasing && watched->isWidgetType() && static_cast<QWidget*>( watched )->isWindow() )
+            {
+                QWidget* window = static_cast<QWidget*>( watched );
+                QHash<QObject*, windowState>::iterator it = windows.find( watched );
+                if( it == windows.end() )
+                {
+                    windowState state;
+                    state.window = window;
+                    state.lastRepaint = -1000000;
+                    state.held = false;
+                    state.factor = 1;
+                    state.heldCount = 0;
+                    it = windows.insert( watched, state );
+                    QObject::connect( watched, SIGNAL( destroyed( QObject* ) ), this, SLOT( windowDestroyed( QObject* ) ) );
+                }
+
+                // Hold the request back if the window was repainted too recently.
+                // Qt won't post another request for the window until this one is
+                // delivered, so further updates simply add to the area to repaint.
+                windowState& state = it.value();
+                state.factor = windowFactor( window );
+                if( clock.elapsed() - state.lastRepaint < windowInterval( state.factor ) )
+                {
+                    if( !state.held )
+                    {
+                        state.held = true;
+                        state.heldCount++;
+                        totalHeld++;
+                    }
+                    if( !tickTimer.isActive() )
+                    {
+                        tickTimer.start();
+                    }
+                    return true;
+                }
+
+                // Repaint now
+                deliver( window );
+                return true;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    return QObject::eventFilter( watched, event );
+}
+
+//------------------------------------------------------------------------------
+// Repaint a window now, timing how long the repaint takes
+void refreshGovernor::deliver( QWidget* window )
+{
+    QElapsedTimer paintTimer;
+    paintTimer.start();
+
+    releasing = true;
+    QEvent request( QEvent::UpdateRequest );
+    QCoreApplication::sendEvent( window, &request );
+    releasing = false;
+
+    paintTime += paintTimer.nsecsElapsed();
+    repaints++;
+
+    // Look the window up again, as it may have been removed while repainting
+    QHash<QObject*, windowState>::iterator it = windows.find( window );
+    if( it != windows.end() )
+    {
+        it.value().held = false;
+        it.value().lastRepaint = clock.elapsed();
+    }
+}
+
+//------------------------------------------------------------------------------
+// Display tick. Deliver the held update requests that are now due.
+// If none are held the display is quiet, so stop ticking until a request is next held.
+void refreshGovernor::tick()
+{
+    const qint64 now = clock.elapsed();
+    QList<QPointer<QWidget> > due;
+    bool anyHeld = false;
+
+    QHash<QObject*, windowState>::iterator it = windows.begin();
+    while( it != windows.end() )
+    {
+        windowState& state = it.value();
+        if( state.held )
+        {
+            anyHeld = true;
+
+            // Check the priority again. The window may have gained focus, or the load may have fallen.
+            state.factor = state.window ? windowFactor( state.window ) : 1;
+            if( now - state.lastRepaint >= windowInterval( state.factor ) )
+            {
+                due.append( state.window );
+            }
+        }
+        ++it;
+    }
+
+    if( !anyHeld )
+    {
+        tickTimer.stop();
+        return;
+    }
+
+    for( int i = 0; i < due.count(); i++ )
+    {
+        // The window may have been closed since the request was held
+        if( due[i] )
+        {
+            deliver( due[i] );
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// A window has gone away
+void refreshGovernor::windowDestroyed( QObject* window )
+{
+    windows.remove( window );
+}
+
+//------------------------------------------------------------------------------
+// Measure how late the lag timer fires
+void refreshGovernor::checkLag()
+{
+    const qint64 lag = lagInterval.restart() - LAG_INTERVAL;
+    maxLag = qMax( maxLag, lag );
+}
+
+//------------------------------------------------------------------------------
+// Measure the rates in and out, and publish them.
+// If adaptive, measure the load and raise or lower the load level.
+void refreshGovernor::measureRates()
+{
+    const qint64 elapsed = qMax( qint64( 1 ), rateInterval.restart() );
+    const double seconds = elapsed / 1000.0;
+
+    updateRate = updates / seconds;
+    repaintRate = repaints / seconds;
+    peakUpdateRate = qMax( peakUpdateRate, updateRate );
+    peakRepaintRate = qMax( peakRepaintRate, repaintRate );
+    totalUpdates += updates;
+    totalRepaints += repaints;
+    updates = 0;
+    repaints = 0;
+
+    lastLag = maxLag;
+    lastPaintLoad = paintTime / ( elapsed * 1000000.0 );
+    maxLag = 0;
+    paintTime = 0;
+
+    if( adaptive )
+    {
+        if( lastLag > LAG_HIGH || lastPaintLoad > PAINT_LOAD_HIGH )
+        {
+            setLoadLevel( qMin( loadLevel + 1, MAX_LOAD_LEVEL ) );
+        }
+        else if( lastLag < LAG_LOW && lastPaintLoad < PAINT_LOAD_LOW )
+        {
+            setLoadLevel( qMax( loadLevel - 1, 0 ) );
+        }
+    }
+
+    emit ratesChanged( getRateSummary() );
+}
+
+//------------------------------------------------------------------------------
+// Set the load level, and let anyone interested know
+void refreshGovernor::setLoadLevel( const int level )
+{
+    if( level == loadLevel )
+    {
+        return;
+    }
+
+    loadLevel = level;
+    peakLoadLevel = qMax( peakLoadLevel, loadLevel );
+    loadLevelChanges++;
+    emit loadLevelChanged( loadLevel );
+}
+
+//------------------------------------------------------------------------------
+// Brief summary of the current rates, suitable for the status bar
+QString refreshGovernor::getRateSummary() const
+{
+    QString summary = QString( "Updates %1/s  Repaints %2/s" )
+                          .arg( updateRate, 0, 'f', 0 )
+                          .arg( repaintRate, 0, 'f', 0 );
+    if( adaptive )
+    {
+        summary.append( loadLevel ? QString( "  Throttling %1" ).arg( loadLevel ) : QString( "  Full rate" ) );
+    }
+    return summary;
+}
+
+//------------------------------------------------------------------------------
+// Summary suitable for presenting to the user.
+// If adaptive, lists the windows currently throttled.
+QString refreshGovernor::getStatistics() const
+{
+    if( !isEnabled() )
+    {
+        return QString( "Refresh governor: not enabled (-y or -A option)." );
+    }
+
+    QString statistics = QString( "Refresh governor: limit %1, %2 updates in (now %3/s, peak %4/s), %5 repaints out (now %6/s, peak %7/s), %8 repaints held to a display tick." )
+                             .arg( maxRate > 0.0 ? QString( "%1 Hz" ).arg( maxRate, 0, 'f', 1 ) : QString( "none" ) )
+                             .arg( totalUpdates )
+                             .arg( updateRate, 0, 'f', 0 )
+                             .arg( peakUpdateRate, 0, 'f', 0 )
+                             .arg( totalRepaints )
+                             .arg( repaintRate, 0, 'f', 0 )
+                             .arg( peakRepaintRate, 0, 'f', 0 )
+                             .arg( totalHeld );
+
+    if( !adaptive )
+    {
+        return statistics;
+    }
+
+    statistics.append( QString( "\nAdaptive throttling: load level %1 of %2 (peak %3, %4 changes), event loop lag %5 mS, %6% of time repainting." )
+                           .arg( loadLevel )
+                           .arg( MAX_LOAD_LEVEL )
+                           .arg( peakLoadLevel )
+                           .arg( loadLevelChanges )
+                           .arg( lastLag )
+                           .arg( lastPaintLoad * 100.0, 0, 'f', 0 ) );
+
+    if( loadLevel >= 1 )
+    {
+        statistics.append( "\n   GUIs in background tabs and hidden docks: suspended" );
+    }
+
+    const double fullRate = maxRate > 0.0 ? maxRate : ADAPTIVE_BASE_RATE;
+    QHash<QObject*, windowState>::const_iterator it = windows.constBegin();
+    while( it != windows.constEnd() )
+    {
+        const windowState& state = it.value();
+        const int factor = state.window ? windowFactor( state.window ) : 1;
+        if( factor > 1 )
+        {
+            statistics.append( QString( "\n   %1: %2 at 1/%3 rate (%4 Hz), %5 repaints held" )
+                                   .arg( state.window->windowTitle() )
+                                   .arg( qobject_cast<QDockWidget*>( state.window.data() ) ? "floating dock" : "main window" )
+                                   .arg( factor )
+                                   .arg( fullRate / factor, 0, 'f', 1 )
+                                   .arg( state.heldCount ) );
+        }
+        ++it;
+    }
+
+    return statistics;
+}
+
+// end
@@ -0,0 +1,143 @@
+/*  refreshGovernor.h
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+/*
+ * DESCRIPTION:
+ *
+ * When requested (-y option) this class limits how often main windows are
+ * repainted, so fast PVs (10-100 Hz) do not cause a repaint for every update.
+ *
+ * QE widgets present a new value by calling update(), which marks part of the
+ * widget as needing repainting and, if no repaint is already pending, posts an
+ * update request to the top level window. When the request is delivered all the
+ * areas marked since are repainted in one pass, each widget painting its latest
+ * value. This class watches (as an application wide event filter) for update
+ * requests to top level windows. If a window was repainted less than one display
+ * tick ago the request is held back until the tick is up. Meanwhile further
+ * updates just add to the area marked for repainting, so however many updates
+ * arrive, each window is repainted at most once per tick, with the latest values.
+ * A request arriving more than a tick after the window was last repainted is
+ * delivered straight away, so occasional updates are not delayed.
+ *
+ * When adaptive governing is requested (-A option) the load on the GUI thread is
+ * also measured - how late a regular timer fires (event loop lag), and the proportion
+ * of time spent repainting. As the load rises the load level is raised, and lower
+ * priority GUIs are throttled in order:
+ *    level 1 - GUIs in background tabs and hidden docks are suspended (refer to formSuspender)
+ *    level 2 - main windows without focus are repainted at half rate (quarter, eighth at higher levels)
+ *    level 3 - floating docks without focus are repainted at half rate (quarter at level 4)
+ * The window with focus is always repainted at the full rate. As the load falls,
+ * the load level is lowered again.
+ *
+ * Rates in (queued signal deliveries, which are predominantly PV updates) and out
+ * (repaints) are measured each second and published for display in the status bar.
+ */
+
+#ifndef QEGUI_REFRESH_GOVERNOR_H
+#define QEGUI_REFRESH_GOVERNOR_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QPointer>
+#include <QString>
+#include <QTimer>
+#include <QWidget>
+
+// Class limiting the rate at which main windows are repainted
+class refreshGovernor : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit refreshGovernor( QObject* parent = 0 );
+    ~refreshGovernor();
+
+    void setMaxRate( const double maxRateIn );          // Set the maximum repaint rate (Hz). Zero for no limit
+    double getMaxRate() const { return maxRate; }
+    void setAdaptive( const bool adaptiveIn );          // Throttle lower priority GUIs as the load on the GUI thread rises
+    bool isAdaptive() const { return adaptive; }
+    bool isEnabled() const { return maxRate > 0.0 || adaptive; }
+
+    int getLoadLevel() const { return loadLevel; }      // Current load level (0 when not loaded, or not adaptive)
+
+    QString getRateSummary() const;                     // Brief summary of the current rates, suitable for the status bar
+    QString getStatistics() const;                      // Summary suitable for presenting to the user
+
+signals:
+    void ratesChanged( const QString& summary );        // The rates have been measured again (once a second)
+    void loadLevelChanged( int level );                 // The load level has changed (adaptive only)
+
+protected:
+    bool eventFilter( QObject* watched, QEvent* event );
+
+private:
+    // Repaint state of each top level window
+    class windowState
+    {
+    public:
+        QPointer<QWidget> window;                       // The window (guarded, in case it is deleted while a request is held)
+        qint64 lastRepaint;                             // Time the window was last repainted (mS since enabled)
+        bool held;                                      // True if an update request is held back
+        int factor;                                     // Throttle factor when last checked (1 for full rate)
+        qint64 heldCount;                               // Number of update requests held back
+    };
+
+    QHash<QObject*, windowState> windows;               // All top level windows repainted since enabled
+
+    void start();                                       // Start watching events
+    void stop();                                        // Stop watching events, delivering anything held back
+    int windowFactor( QWidget* window ) const;          // Return the throttle factor for a window given its priority and the load
+    qint64 windowInterval( const int factor ) const;    // Return the minimum time between repaints of a window given its throttle factor (mS)
+    void deliver( QWidget* window );                    // Repaint a window now
+    void setLoadLevel( const int level );
+
+    double maxRate;                                     // Maximum repaint rate (Hz)
+    bool adaptive;                                      // True if throttling lower priority GUIs as the load rises
+    bool running;                                       // True while watching events
+    bool releasing;                                     // True while delivering an update request
+
+    QElapsedTimer clock;                                // Time since enabled
+    QTimer tickTimer;                                   // Display tick. Only runs while update requests are held back
+    QTimer rateTimer;                                   // Measures the rates each second
+    QElapsedTimer rateInterval;                         // Time since the rates were last measured
+
+    int updates;                                        // Updates in since the rates were last measured
+    int repaints;                                       // Repaints out since the rates were last measured
+    double updateRate;                                  // Last measured rate of updates in (Hz)
+    double repaintRate;                                 // Last measured rate of repaints out (Hz)
+    double peakUpdateRate;                              // Highest measured rate of updates in (Hz)
+    double peakRepaintRate;                             // Highest measured rate of repaints out (Hz)
+    qint64 totalUpdates;                                // Total updates in
+    qint64 totalRepaints;                               // Total repaints out
+    qint64 totalHeld;                                   // Total update requests held back to a tick
+
+    // Load measurement (adaptive only)
+    QTimer lagTimer;                                    // Regular timer. The lateness of each timeout is the event loop lag
+    QElapsedTimer lagInterval;                          // Time since the lag timer last fired
+    qint64 maxLag;                                      // Worst event loop lag since the load was last measured (mS)
+    qint64 paintTime;                                   // Time spent repainting since the load was last measured (nS)
+    qint64 lastLag;                                     // Worst event loop lag in the last measurement (mS)
+    double lastPaintLoad;                               // Proportion of time spent repainting in the last measurement
+    int loadLevel;                                      // Current load level
+    int peakLoadLevel;                                  // Highest load level reached
+    int loadLevelChanges;                               // Number of times the load level has changed
+
+private slots:
+    void tick();
+    void measureRates();
+    void checkLag();
+    void windowDestroyed( QObject* window );
+};
+
+#endif // QEGUI_REFRESH_GOVERNOR_H
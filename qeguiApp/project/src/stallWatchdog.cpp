@@ -0,0 +1,273 @@
+/*  stallWatchdog.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+// Watch for the GUI thread stalling. Refer to stallWatchdog.h for details.
+
+#include "stallWatchdog.h"
+#include <QApplication>
+#include <QDebug>
+#include <QMetaEnum>
+#include <QMutexLocker>
+#include <QWidget>
+#include <QEForm.h>
+
+#define DEBUG qDebug() << "stallWatchdog" << __LINE__ << __FUNCTION__ << "  "
+
+// Interval between heartbeats on the GUI thread (mS)
+#define HEARTBEAT_INTERVAL  50
+
+// Lowest stall threshold that may be requested (mS)
+#define MIN_THRESHOLD       100
+
+// Number of recent stalls kept
+#define MAX_RECORDS         100
+
+//------------------------------------------------------------------------------
+// Construction
+stallWatchdog::stallWatchdog( QObject* parent ) : QThread( parent )
+{
+    enabled = false;
+    threshold = 0;
+    stallCount = 0;
+    longestStall = 0;
+    totalStallTime = 0;
+
+    heartbeatTimer.setTimerType( Qt::PreciseTimer );
+    heartbeatTimer.setInterval( HEARTBEAT_INTERVAL );
+    QObject::connect( &heartbeatTimer, SIGNAL( timeout() ), this, SLOT( beat() ) );
+}
+
+stallWatchdog::~stallWatchdog()
+{
+    disable();
+}
+
+//------------------------------------------------------------------------------
+// Start watching, with a stall threshold (mS). Zero (or less) does nothing.
+void stallWatchdog::enable( const double thresholdIn )
+{
+    if( enabled || thresholdIn <= 0.0 )
+    {
+        return;
+    }
+
+    threshold = qMax( qint64( MIN_THRESHOLD ), qint64( thresholdIn ) );
+    enabled = true;
+
+    clock.start();
+    heartbeat.storeRelease( clock.elapsed() );
+    heartbeatTimer.start();
+
+    QObject::connect( qApp, SIGNAL( focusChanged( QWidget*, QWidget* ) ), this, SLOT( focusChanged( QWidget*, QWidget* ) ) );
+
+    start( QThread::HighPriority );
+}
+
+//------------------------------------------------------------------------------
+// Stop watching
+void stallWatchdog::disable()
+{
+    if( !enabled )
+    {
+        return;
+    }
+    enabled = false;
+
+    heartbeatTimer.stop();
+    QObject::disconnect( qApp, SIGNAL( focusChanged( QWidget*, QWidget* ) ), this, SLOT( focusChanged( QWidget*, QWidget* ) ) );
+
+    requestInterruption();
+    wait();
+}
+
+//------------------------------------------------------------------------------
+// Heartbeat (GUI thread)
+void stallWatchdog::beat()
+{
+    heartbeat.storeRelease( clock.elapsed() );
+}
+
+//------------------------------------------------------------------------------
+// Note the window and GUI with focus (GUI thread)
+void stallWatchdog::focusChanged( QWidget*, QWidget* now )
+{
+    if( !now )
+    {
+        return;
+    }
+
+    // Find the GUI containing the widget with focus, if any
+    QEForm* form = NULL;
+    for( QObject* object = now; object && !form; object = object->parent() )
+    {
+        form = qobject_cast<QEForm*>( object );
+    }
+
+    QMutexLocker locker( &mutex );
+    focusWindowTitle = now->window()->windowTitle();
+    focusFormTitle = form ? form->getQEGuiTitle() : QString();
+    focusFormFile = form ? form->getFullFileName() : QString();
+}
+
+//------------------------------------------------------------------------------
+// Watchdog thread.
+// Check the heartbeat regularly. When it stops for longer than the threshold,
+// note what the GUI thread is doing. When it resumes, record the stall.
+void stallWatchdog::run()
+{
+    const unsigned long poll = qMax( qint64( 10 ), threshold / 4 );
+    bool stalled = false;
+    stallRecord record;
+    qint64 stallStart = 0;
+
+    while( !isInterruptionRequested() )
+    {
+        msleep( poll );
+
+        const qint64 now = clock.elapsed();
+        const qint64 lastBeat = heartbeat.loadAcquire();
+
+        if( !stalled )
+        {
+            if( now - lastBeat <= threshold )
+            {
+                continue;
+            }
+
+            // The GUI thread has stalled. Note what it is doing.
+            stalled = true;
+            stallStart = lastBeat;
+            record.start = QDateTime::currentDateTime().addMSecs( lastBeat - now );
+            record.depth = depth.loadAcquire();
+            record.eventType = record.depth ? currentType.loadAcquire() : int( QEvent::None );
+            const char* receiverClass = currentClass.loadAcquire();
+            record.receiverClass = record.depth && receiverClass ? QString( receiverClass ) : QString();
+            record.receiver = record.depth ? currentReceiver.loadAcquire() : NULL;
+
+            QMutexLocker locker( &mutex );
+            record.windowTitle = focusWindowTitle;
+            record.formTitle = focusFormTitle;
+            record.formFile = focusFormFile;
+        }
+        else if( lastBeat > stallStart )
+        {
+            // The GUI thread has resumed. The first beat after the stall was due one interval after the last beat before it.
+            stalled = false;
+            record.duration = lastBeat - stallStart - HEARTBEAT_INTERVAL;
+
+            QMutexLocker locker( &mutex );
+            records.append( record );
+            if( records.count() > MAX_RECORDS )
+            {
+                records.removeFirst();
+            }
+            stallCount++;
+            longestStall = qMax( longestStall, record.duration );
+            totalStallTime += record.duration;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// Return the name of an event type
+QString stallWatchdog::eventTypeName( const int type )
+{
+    const QMetaObject& mo = QEvent::staticMetaObject;
+    const int index = mo.indexOfEnumerator( "Type" );
+    const char* key = index >= 0 ? mo.enumerator( index ).valueToKey( type ) : NULL;
+    return key ? QString( key ) : QString::number( type );
+}
+
+//------------------------------------------------------------------------------
+// Format a stall record for presentation
+QString stallWatchdog::formatRecord( const stallRecord& record )
+{
+    QString text = QString( "%1  %2 mS  " )
+                       .arg( record.start.toString( "yyyy-MM-dd hh:mm:ss.zzz" ) )
+                       .arg( record.duration, 6 );
+
+    if( record.depth )
+    {
+        text.append( QString( "%1 event to %2 (0x%3)" )
+                         .arg( eventTypeName( record.eventType ) )
+                         .arg( record.receiverClass )
+                         .arg( quintptr( record.receiver ), 0, 16 ) );
+        if( record.depth > 1 )
+        {
+            text.append( QString( " nested %1 deep" ).arg( record.depth ) );
+        }
+    }
+    else
+    {
+        text.append( "not dispatching an event" );
+    }
+
+    text.append( QString( ", focus in window '%1'" ).arg( record.windowTitle ) );
+    if( !record.formFile.isEmpty() )
+    {
+        text.append( QString( ", GUI '%1' (%2)" ).arg( record.formTitle ).arg( record.formFile ) );
+    }
+    return text;
+}
+
+//------------------------------------------------------------------------------
+// List of the recorded stalls, oldest first
+QString stallWatchdog::getStallReport() const
+{
+    QMutexLocker locker( &mutex );
+    QString report;
+    for( int i = 0; i < records.count(); i++ )
+    {
+        report.append( formatRecord( records[i] ) ).append( "\n" );
+    }
+    return report;
+}
+
+//------------------------------------------------------------------------------
+// Number of recorded stalls (in the ring buffer)
+int stallWatchdog::getStallCount() const
+{
+    QMutexLocker locker( &mutex );
+    return records.count();
+}
+
+//------------------------------------------------------------------------------
+// Summary suitable for presenting to the user, including the recorded stalls
+QString stallWatchdog::getStatistics() const
+{
+    if( !enabled )
+    {
+        return QString( "Stall watchdog: not enabled (-S option)." );
+    }
+
+    QString statistics;
+    {
+        QMutexLocker locker( &mutex );
+        statistics = QString( "Stall watchdog: threshold %1 mS, %2 stalls, longest %3 mS, %4 mS stalled in total. Most recent %5:" )
+                         .arg( threshold )
+                         .arg( stallCount )
+                         .arg( longestStall )
+                         .arg( totalStallTime )
+                         .arg( records.count() );
+    }
+
+    const QString report = getStallReport();
+    if( !report.isEmpty() )
+    {
+        statistics.append( "\n" ).append( report );
+        statistics.chop( 1 );
+    }
+    return statistics;
+}
+
+// end
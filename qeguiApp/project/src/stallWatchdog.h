@@ -0,0 +1,148 @@
+/*  stallWatchdog.h
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+/*
+ * DESCRIPTION:
+ *
+ * When requested (-S option) this class watches for the GUI thread stalling,
+ * and records what it was doing at the time.
+ *
+ * A timer on the GUI thread updates a heartbeat every 50 mS. A watchdog thread
+ * checks the heartbeat, and if it has not been updated for longer than the
+ * threshold the GUI thread has stalled. The watchdog then takes a snapshot of
+ * what the GUI thread is doing: the event being processed and its receiver (the
+ * application notes these as it dispatches each event), and the main window
+ * and GUI (QEForm) that last had focus. When the heartbeat resumes the duration
+ * of the stall is added and the record is kept in a ring buffer of the most
+ * recent stalls.
+ *
+ * The application notes each event with a few atomic stores (event type, receiver
+ * address and receiver class name, which is static data) so the cost per event is
+ * negligible. Object names are not noted, as they can't safely be read from the
+ * watchdog thread.
+ *
+ * The recorded stalls are listed on the Performance tab of the 'About' dialog,
+ * and written to stderr on exit.
+ */
+
+#ifndef QEGUI_STALL_WATCHDOG_H
+#define QEGUI_STALL_WATCHDOG_H
+
+#include <QThread>
+#include <QAtomicInteger>
+#include <QAtomicPointer>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QTimer>
+
+class QWidget;
+
+// Class watching for the GUI thread stalling
+class stallWatchdog : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit stallWatchdog( QObject* parent = 0 );
+    ~stallWatchdog();
+
+    void enable( const double thresholdIn );            // Start watching with a stall threshold (mS). Zero (or less) does nothing
+    void disable();                                     // Stop watching
+    bool isEnabled() const { return enabled; }
+
+    // The event being dispatched on the GUI thread
+    class eventFrame
+    {
+    public:
+        int type;                                       // Event type
+        const char* receiverClass;                      // Receiver class name (static meta object data)
+        QObject* receiver;                              // Receiver (address only, never dereferenced by the watchdog)
+    };
+
+    // Note an event is about to be dispatched on the GUI thread. The current event (if any) is saved in 'saved'
+    void enterEvent( QObject* receiver, QEvent* event, eventFrame& saved )
+    {
+        saved.type = currentType.loadAcquire();
+        saved.receiverClass = currentClass.loadAcquire();
+        saved.receiver = currentReceiver.loadAcquire();
+        currentType.storeRelease( event->type() );
+        currentClass.storeRelease( receiver->metaObject()->className() );
+        currentReceiver.storeRelease( receiver );
+        depth.ref();
+    }
+
+    // Note an event has been dispatched on the GUI thread. The event being dispatched before (if any) is restored from 'saved'
+    void leaveEvent( const eventFrame& saved )
+    {
+        depth.deref();
+        currentType.storeRelease( saved.type );
+        currentClass.storeRelease( saved.receiverClass );
+        currentReceiver.storeRelease( saved.receiver );
+    }
+
+    QString getStallReport() const;                     // List of the recorded stalls
+    int getStallCount() const;                          // Number of recorded stalls (in the ring buffer)
+    QString getStatistics() const;                      // Summary suitable for presenting to the user
+
+protected:
+    void run();                                         // Watchdog thread
+
+private:
+    // A recorded stall
+    class stallRecord
+    {
+    public:
+        QDateTime start;                                // Time the stall started
+        qint64 duration;                                // Duration (mS)
+        int eventType;                                  // Event being dispatched (QEvent::None if none)
+        QString receiverClass;                          // Class of the event receiver
+        QObject* receiver;                              // Address of the event receiver
+        int depth;                                      // Event nesting depth (0 if not dispatching an event)
+        QString windowTitle;                            // Window with focus
+        QString formTitle;                              // GUI with focus
+        QString formFile;                               // .ui file of the GUI with focus
+    };
+
+    static QString eventTypeName( const int type );     // Return the name of an event type
+    static QString formatRecord( const stallRecord& record );   // Format a stall record for presentation
+
+    bool enabled;                                       // Only accessed on the GUI thread
+    qint64 threshold;                                   // Stall threshold (mS)
+    QElapsedTimer clock;                                // Shared time base (read by both threads)
+    QTimer heartbeatTimer;                              // GUI thread timer updating the heartbeat
+    QAtomicInteger<qint64> heartbeat;                   // Time of the last heartbeat (mS)
+
+    QAtomicInt currentType;                             // Event being dispatched on the GUI thread
+    QAtomicPointer<const char> currentClass;
+    QAtomicPointer<QObject> currentReceiver;
+    QAtomicInt depth;                                   // Event nesting depth on the GUI thread
+
+    mutable QMutex mutex;                               // Protects the following
+    QString focusWindowTitle;                           // Window that last had focus
+    QString focusFormTitle;                             // GUI that last had focus
+    QString focusFormFile;
+    QList<stallRecord> records;                         // Ring buffer of recent stalls
+    int stallCount;                                     // Total number of stalls
+    qint64 longestStall;                                // Longest stall (mS)
+    qint64 totalStallTime;                              // Total time stalled (mS)
+
+private slots:
+    void beat();
+    void focusChanged( QWidget* old, QWidget* now );
+};
+
+#endif // QEGUI_STALL_WATCHDOG_H
@@ -0,0 +1,291 @@
+/*  startupTrace.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+// Startup tracing. Refer to startupTrace.h for details.
+
+#include "startupTrace.h"
+#include <ctime>
+#include <iostream>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+
+#define DEBUG qDebug() << "startupTrace" << __LINE__ << __FUNCTION__ << "  "
+
+// Number of slowest phases listed in the summary
+#define SUMMARY_PHASES  3
+
+namespace {
+
+// A recorded span
+struct traceSpan
+{
+    QString name;
+    QString category;
+    QString detail;
+    double wallStart;       // uS
+    double wallDuration;    // uS
+    double cpuDuration;     // uS
+};
+
+QElapsedTimer originTimer;          // Wall time origin
+std::clock_t originCpu = 0;         // CPU time origin
+bool enabled = false;               // Tracing requested and not yet complete
+QString traceFileName;              // Trace output file
+QList<traceSpan> spans;             // Spans recorded so far
+
+QString phaseName;                  // Current phase, if any
+double phaseWallStart = 0.0;        // Current phase start times
+double phaseCpuStart = 0.0;
+
+}
+
+//------------------------------------------------------------------------------
+// Mark the start of the trace. Called as early as possible.
+void startupTrace::markOrigin()
+{
+    originTimer.start();
+    originCpu = std::clock();
+}
+
+//------------------------------------------------------------------------------
+// Enable tracing. An empty file name does nothing.
+void startupTrace::enable( const QString& fileName )
+{
+    if( fileName.isEmpty() )
+    {
+        return;
+    }
+
+    if( !originTimer.isValid() )
+    {
+        markOrigin();
+    }
+
+    traceFileName = fileName;
+    enabled = true;
+}
+
+//------------------------------------------------------------------------------
+// Return true if tracing is enabled (and startup not yet complete)
+bool startupTrace::isEnabled()
+{
+    return enabled;
+}
+
+//------------------------------------------------------------------------------
+// Wall time since the origin (microseconds)
+double startupTrace::getWallTime()
+{
+    return originTimer.isValid() ? originTimer.nsecsElapsed() / 1000.0 : 0.0;
+}
+
+//------------------------------------------------------------------------------
+// Process CPU time since the origin (microseconds)
+double startupTrace::getCpuTime()
+{
+    return ( double( std::clock() - originCpu ) * 1000000.0 ) / CLOCKS_PER_SEC;
+}
+
+//------------------------------------------------------------------------------
+// Record a span
+void startupTrace::record( const QString& name, const QString& category,
+                           const double wallStart, const double wallEnd,
+                           const double cpuStart, const double cpuEnd,
+                           const QString& detail )
+{
+    if( !enabled )
+    {
+        return;
+    }
+
+    traceSpan span;
+    span.name = name;
+    span.category = category;
+    span.detail = detail;
+    span.wallStart = wallStart;
+    span.wallDuration = wallEnd - wallStart;
+    span.cpuDuration = cpuEnd - cpuStart;
+    spans.append( span );
+}
+
+//------------------------------------------------------------------------------
+// End any current phase and begin the next.
+// The start time is always captured, so a phase begun before tracing is enabled
+// (such as argument parsing) is still recorded.
+void startupTrace::beginPhase( const QString& name )
+{
+    endPhase();
+
+    phaseName = name;
+    phaseWallStart = getWallTime();
+    phaseCpuStart = getCpuTime();
+}
+
+//------------------------------------------------------------------------------
+// End any current phase
+void startupTrace::endPhase()
+{
+    if( phaseName.isEmpty() )
+    {
+        return;
+    }
+
+    record( phaseName, "phase", phaseWallStart, getWallTime(), phaseCpuStart, getCpuTime(), QString() );
+    phaseName.clear();
+}
+
+//------------------------------------------------------------------------------
+// Startup is complete.
+// Write the trace as Chrome trace event format JSON and write a summary to stderr.
+void startupTrace::complete()
+{
+    if( !enabled )
+    {
+        return;
+    }
+    endPhase();
+    enabled = false;
+
+    const double wallTotal = getWallTime();
+    const double cpuTotal = getCpuTime();
+    const qint64 pid = QCoreApplication::applicationPid();
+
+    // Build the trace. Spans are all complete events ("ph":"X") on the GUI thread.
+    QJsonArray events;
+    for( int i = 0; i < spans.count(); i++ )
+    {
+        const traceSpan& span = spans[i];
+
+        QJsonObject args;
+        args.insert( "cpu_ms", span.cpuDuration / 1000.0 );
+        if( !span.detail.isEmpty() )
+        {
+            args.insert( "detail", span.detail );
+        }
+
+        QJsonObject event;
+        event.insert( "name", span.name );
+        event.insert( "cat", span.category );
+        event.insert( "ph", QString( "X" ) );
+        event.insert( "ts", span.wallStart );
+        event.insert( "dur", span.wallDuration );
+        event.insert( "pid", pid );
+        event.insert( "tid", 1 );
+        event.insert( "args", args );
+        events.append( event );
+    }
+
+    // Mark the end of startup
+    QJsonObject completeEvent;
+    completeEvent.insert( "name", QString( "startup complete" ) );
+    completeEvent.insert( "cat", QString( "phase" ) );
+    completeEvent.insert( "ph", QString( "i" ) );
+    completeEvent.insert( "s", QString( "p" ) );
+    completeEvent.insert( "ts", wallTotal );
+    completeEvent.insert( "pid", pid );
+    completeEvent.insert( "tid", 1 );
+    events.append( completeEvent );
+
+    QJsonObject trace;
+    trace.insert( "traceEvents", events );
+    trace.insert( "displayTimeUnit", QString( "ms" ) );
+
+    QFile file( traceFileName );
+    if( file.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+    {
+        file.write( QJsonDocument( trace ).toJson( QJsonDocument::Compact ) );
+        file.close();
+    }
+    else
+    {
+        DEBUG << traceFileName << " file open (write) failed";
+    }
+
+    // Build the summary - totals, form creation, and the slowest phases
+    int formCount = 0;
+    double formWall = 0.0;
+    QList<const traceSpan*> slowest;
+    for( int i = 0; i < spans.count(); i++ )
+    {
+        const traceSpan* span = &spans[i];
+        if( span->category == "form" && span->name == "createGui" )
+        {
+            formCount++;
+            formWall += span->wallDuration;
+        }
+        else if( span->category == "phase" )
+        {
+            int j = 0;
+            while( j < slowest.count() && slowest[j]->wallDuration >= span->wallDuration )
+            {
+                j++;
+            }
+            slowest.insert( j, span );
+        }
+    }
+
+    QString summary = QString( "qegui startup: %1 ms wall, %2 ms CPU, %3 forms in %4 ms" )
+                          .arg( wallTotal / 1000.0, 0, 'f', 1 )
+                          .arg( cpuTotal / 1000.0, 0, 'f', 1 )
+                          .arg( formCount )
+                          .arg( formWall / 1000.0, 0, 'f', 1 );
+    for( int i = 0; i < slowest.count() && i < SUMMARY_PHASES; i++ )
+    {
+        summary.append( i ? ", " : "; slowest: " );
+        summary.append( QString( "%1 %2 ms" ).arg( slowest[i]->name ).arg( slowest[i]->wallDuration / 1000.0, 0, 'f', 1 ) );
+    }
+    summary.append( QString( " (trace written to %1)" ).arg( traceFileName ) );
+
+    std::cerr << summary.toLocal8Bit().constData() << std::endl;
+
+    spans.clear();
+}
+
+//------------------------------------------------------------------------------
+// Start a span. Nothing is captured unless tracing is enabled.
+startupTraceScope::startupTraceScope( const char* nameIn, const char* categoryIn, const QString& detailIn )
+{
+    active = startupTrace::isEnabled();
+    name = nameIn;
+    category = categoryIn;
+    wallStart = 0.0;
+    cpuStart = 0.0;
+    if( !active )
+    {
+        return;
+    }
+
+    detail = detailIn;
+    wallStart = startupTrace::getWallTime();
+    cpuStart = startupTrace::getCpuTime();
+}
+
+//------------------------------------------------------------------------------
+// End a span and record it (if tracing was enabled when it started, and still is)
+startupTraceScope::~startupTraceScope()
+{
+    if( active && startupTrace::isEnabled() )
+    {
+        startupTrace::record( name, category,
+                              wallStart, startupTrace::getWallTime(),
+                              cpuStart, startupTrace::getCpuTime(), detail );
+    }
+}
+
+// end
@@ -0,0 +1,82 @@
+/*  startupTrace.h
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+/*
+ * DESCRIPTION:
+ *
+ * Startup tracing. When requested (-g option) the wall clock and CPU time of each
+ * startup phase in QEGui::run(), and of each form created (MainWindow::createGui()
+ * and QEForm::readUiFile()), is recorded.
+ *
+ * Startup is deemed complete when the event loop first runs. At that point the
+ * trace is written to the requested file in Chrome trace event format (viewable
+ * using chrome://tracing or https://ui.perfetto.dev) and a one line summary is
+ * written to stderr.
+ *
+ * Sequential phases are recorded using beginPhase(), each phase ending when the
+ * next begins. Other spans are recorded using a startupTraceScope object, which
+ * records the time between its construction and destruction. Recording is cheap,
+ * and a startupTraceScope does nothing (not even read the clocks) when tracing is
+ * not enabled.
+ *
+ * The trace is also written if QEGui exits before the event loop runs (for
+ * example, after printing help or the version).
+ */
+
+#ifndef QEGUI_STARTUP_TRACE_H
+#define QEGUI_STARTUP_TRACE_H
+
+#include <QString>
+
+// Class managing the startup trace. All methods are static as there is only one startup.
+class startupTrace
+{
+public:
+    static void markOrigin();                               // Mark the start of the trace (application construction)
+    static void enable( const QString& fileName );          // Enable tracing, writing the trace to the given file
+    static bool isEnabled();                                // Return true if tracing is enabled (and not yet complete)
+
+    static double getWallTime();                            // Wall time since the origin (microseconds)
+    static double getCpuTime();                             // Process CPU time since the origin (microseconds)
+
+    // Record a span. Times are as returned by getWallTime() and getCpuTime().
+    static void record( const QString& name, const QString& category,
+                        const double wallStart, const double wallEnd,
+                        const double cpuStart, const double cpuEnd,
+                        const QString& detail );
+
+    static void beginPhase( const QString& name );          // End any current phase and begin the next
+    static void endPhase();                                 // End any current phase
+
+    static void complete();                                 // Startup is complete. Write the trace and summary.
+};
+
+// Class recording the time between its construction and destruction as a trace span
+class startupTraceScope
+{
+public:
+    explicit startupTraceScope( const char* name,
+                                const char* category = "phase",
+                                const QString& detail = QString() );
+    ~startupTraceScope();
+
+private:
+    bool active;                                            // True if tracing was enabled when the span started
+    const char* name;                                       // Span name and category (string literals)
+    const char* category;
+    QString detail;                                         // Only set if active
+    double wallStart;
+    double cpuStart;
+};
+
+#endif // QEGUI_STARTUP_TRACE_H
@@ -0,0 +1,209 @@
+/*  workspaceManager.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+// Manage workspaces kept alive, but suspended, while not in use. Refer to workspaceManager.h for details.
+
+#include "workspaceManager.h"
+#include <QDebug>
+#include <QWidget>
+#include <QEGui.h>
+#include <MainWindow.h>
+
+#define DEBUG qDebug() << "workspaceManager" << __LINE__ << __FUNCTION__ << "  "
+
+// Estimated memory used by each widget in a parked main window (bytes).
+// This is an average over QE widgets (with their PV data) and the plain widgets that lay them out.
+#define ESTIMATED_WIDGET_BYTES  ( 16 * 1024 )
+
+//------------------------------------------------------------------------------
+// Construction
+workspaceManager::workspaceManager( QEGui* appIn )
+{
+    app = appIn;
+    memoryLimit = 0.0;
+    switches = 0;
+    instantSwitches = 0;
+    discarded = 0;
+}
+
+workspaceManager::~workspaceManager()
+{
+}
+
+//------------------------------------------------------------------------------
+// Limit the estimated memory used by parked workspaces (MB)
+void workspaceManager::setMemoryLimit( const double megabytes )
+{
+    memoryLimit = qMax( megabytes, 0.0 );
+    applyLimit();
+}
+
+//------------------------------------------------------------------------------
+// Switch to a workspace.
+// The workspace in use, if any, is saved under its name and parked. The workspace switched to
+// is then shown if it is parked, otherwise it is restored from its saved configuration.
+void workspaceManager::switchTo( PersistanceManager* pm, const QString& configFile, const QString& name )
+{
+    if( name.isEmpty() || ( name == current && app->getMainWindowCount() ) )
+    {
+        return;
+    }
+    switches++;
+
+    // Save and park the workspace in use
+    if( !current.isEmpty() && app->getMainWindowCount() )
+    {
+        app->saveConfiguration( pm, configFile, QE_CONFIG_NAME, current, false );
+        park( current );
+    }
+
+    // Show the workspace if parked, otherwise restore it.
+    // (If the main windows on screen were not a workspace, they are replaced by the restore, reusing any GUIs that match)
+    if( unpark( name ) )
+    {
+        instantSwitches++;
+    }
+    else
+    {
+        app->restoreConfiguration( pm, configFile, QE_CONFIG_NAME, name );
+    }
+    current = name;
+
+    applyLimit();
+}
+
+//------------------------------------------------------------------------------
+// Park the main windows on screen as a workspace
+void workspaceManager::park( const QString& name )
+{
+    workspace ws;
+    ws.name = name;
+
+    int widgets = 0;
+    MainWindow* mw;
+    while( (mw = app->getMainWindow( 0 )) )
+    {
+        widgets += mw->findChildren<QWidget*>().count();
+        mw->park();     // Also removes it from the application's list of main windows
+        ws.windows.append( mw );
+    }
+    ws.megabytes = double( widgets ) * ESTIMATED_WIDGET_BYTES / ( 1024.0 * 1024.0 );
+
+    parked.prepend( ws );
+}
+
+//------------------------------------------------------------------------------
+// Show the main windows of a parked workspace.
+// Returns false if the workspace is not parked (or none of its main windows remain).
+bool workspaceManager::unpark( const QString& name )
+{
+    for( int i = 0; i < parked.count(); i++ )
+    {
+        if( parked[i].name != name )
+        {
+            continue;
+        }
+
+        const workspace ws = parked.takeAt( i );
+        bool shown = false;
+        for( int j = 0; j < ws.windows.count(); j++ )
+        {
+            MainWindow* mw = ws.windows[j];
+            if( mw )
+            {
+                mw->unpark();
+                shown = true;
+            }
+        }
+        return shown;
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------
+// Discard a parked workspace. It will be restored from its saved configuration when next used.
+void workspaceManager::discard( const int i )
+{
+    const workspace ws = parked.takeAt( i );
+    for( int j = 0; j < ws.windows.count(); j++ )
+    {
+        MainWindow* mw = ws.windows[j];
+        if( mw )
+        {
+            mw->discard();
+        }
+    }
+    discarded++;
+}
+
+//------------------------------------------------------------------------------
+// Discard the least recently used parked workspaces while over the memory limit
+void workspaceManager::applyLimit()
+{
+    double total = 0.0;
+    for( int i = 0; i < parked.count(); i++ )
+    {
+        total += parked[i].megabytes;
+    }
+
+    while( !parked.isEmpty() && total > memoryLimit )
+    {
+        total -= parked.last().megabytes;
+        discard( parked.count() - 1 );
+    }
+}
+
+//------------------------------------------------------------------------------
+// Names of the parked workspaces, most recently used first
+QStringList workspaceManager::getParked() const
+{
+    QStringList names;
+    for( int i = 0; i < parked.count(); i++ )
+    {
+        names.append( parked[i].name );
+    }
+    return names;
+}
+
+//------------------------------------------------------------------------------
+// Summary suitable for presenting to the user.
+// Lists the totals, then each parked workspace.
+QString workspaceManager::getStatistics() const
+{
+    double total = 0.0;
+    for( int i = 0; i < parked.count(); i++ )
+    {
+        total += parked[i].megabytes;
+    }
+
+    QString statistics = QString( "Workspaces: %1 in use, %2 parked (%3 MB estimated, limit %4 MB), %5 switches, %6 to a parked workspace, %7 discarded." )
+                             .arg( current.isEmpty() ? QString( "none" ) : QString( "'%1'" ).arg( current ) )
+                             .arg( parked.count() )
+                             .arg( total, 0, 'f', 1 )
+                             .arg( memoryLimit, 0, 'f', 0 )
+                             .arg( switches )
+                             .arg( instantSwitches )
+                             .arg( discarded );
+
+    for( int i = 0; i < parked.count(); i++ )
+    {
+        statistics.append( QString( "\n   %1: %2 main windows, %3 MB estimated" )
+                               .arg( parked[i].name )
+                               .arg( parked[i].windows.count() )
+                               .arg( parked[i].megabytes, 0, 'f', 1 ) );
+    }
+
+    return statistics;
+}
+
+// end
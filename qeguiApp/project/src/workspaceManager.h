@@ -0,0 +1,96 @@
+/*  workspaceManager.h
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  SPDX-FileCopyrightText: 2026 Australian Synchrotron
+ *  SPDX-License-Identifier: LGPL-3.0-only
+ *
+ *  Author:     agent
+ *  Maintainer: Andrew Starritt
+ *  Contact:    andrews@ansto.gov.au
+ */
+
+/*
+ * DESCRIPTION:
+ *
+ * This class manages workspaces. A workspace is a named configuration (as saved
+ * by 'Save Configuration...') that is kept alive while not in use.
+ *
+ * When the user switches from one workspace to another ('Switch Workspace...'),
+ * the configuration of the workspace in use is saved under its name, then its main
+ * windows are 'parked': they are hidden, taken out of the application's list of
+ * main windows, and all their GUIs are suspended (refer to formSuspender.h) so
+ * their widgets stop receiving PV updates. The GUIs are kept in memory.
+ *
+ * Switching to a parked workspace then only needs its main windows shown and its
+ * GUIs re-activated. Nothing is re-read or re-created. Switching to a workspace
+ * that is not parked restores it from the configuration file as usual (refer to
+ * QEGui::restoreConfiguration()).
+ *
+ * Parked workspaces use memory. The memory used by each is estimated when it is
+ * parked from the number of widgets in its main windows. When the total estimate
+ * exceeds the limit (-W option) the least recently used parked workspaces are
+ * discarded. A discarded workspace falls back to its saved configuration, and is
+ * restored from that when next switched to.
+ *
+ * 'Restore Configuration...' is unchanged. It replaces the main windows on screen
+ * (whether or not they were a workspace) and does not make the configuration
+ * restored a workspace.
+ */
+
+#ifndef QEGUI_WORKSPACE_MANAGER_H
+#define QEGUI_WORKSPACE_MANAGER_H
+
+#include <QList>
+#include <QPointer>
+#include <QString>
+#include <QStringList>
+
+class QEGui;
+class MainWindow;
+class PersistanceManager;
+
+// Class managing workspaces kept alive, but suspended, while not in use
+class workspaceManager
+{
+public:
+    explicit workspaceManager( QEGui* appIn );
+    ~workspaceManager();
+
+    void setMemoryLimit( const double megabytes );      // Limit on the estimated memory used by parked workspaces
+
+    // Switch to a workspace. The workspace in use (if any) is saved and parked
+    void switchTo( PersistanceManager* pm, const QString& configFile, const QString& name );
+
+    void clearCurrent() { current.clear(); }            // Note the main windows on screen are no longer a workspace
+    QString getCurrent() const { return current; }      // Name of the workspace in use, empty if none
+    QStringList getParked() const;                      // Names of the parked workspaces, most recently used first
+
+    QString getStatistics() const;                      // Summary suitable for presenting to the user
+
+private:
+    class workspace
+    {
+    public:
+        QString name;                                   // Configuration name
+        QList<QPointer<MainWindow> > windows;           // Parked main windows
+        double megabytes;                               // Estimated memory used
+    };
+
+    void park( const QString& name );                   // Park the main windows on screen as a workspace
+    bool unpark( const QString& name );                 // Show the main windows of a parked workspace. Returns false if not parked
+    void discard( const int i );                        // Discard a parked workspace
+    void applyLimit();                                  // Discard least recently used workspaces while over the memory limit
+
+    QEGui* app;
+    QString current;                                    // Name of the workspace in use, empty if none
+    QList<workspace> parked;                            // Parked workspaces, most recently used first
+    double memoryLimit;                                 // Limit on the estimated memory used by parked workspaces (MB)
+
+    int switches;                                       // Number of switches
+    int instantSwitches;                                // Number of switches to a parked workspace
+    int discarded;                                      // Number of parked workspaces discarded
+};
+
+#endif // QEGUI_WORKSPACE_MANAGER_H